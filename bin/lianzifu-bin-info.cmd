@@ -1,7 +1,15 @@
 @ECHO OFF
+SETLOCAL ENABLEDELAYEDEXPANSION
 
 CD /D "%~dp0"
+SET BINS=
 FOR %%I IN (data\compiled\localization\*strings*.bin) DO (
   ECHO %%~nxI
-  lianzifu.exe --read-bin "data\compiled\localization\%%~nxI" --exit 1> "%~dpn0_%%~nI.log" 2>&1
+  SET BINS=!BINS! "data\compiled\localization\%%~nxI"
+)
+lianzifu.exe --bin-info !BINS! --exit 1> "%~dpn0.log" 2>&1
+
+IF ERRORLEVEL 1 (
+  TYPE "%~dpn0.log"
+  PAUSE
 )
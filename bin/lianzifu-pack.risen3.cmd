@@ -0,0 +1,21 @@
+@ECHO OFF
+ECHO Packing Risen 3 (Windows, PlayStation 3, Xbox 360) string tables...
+
+REM Risen 3 retail (without patch) has string table version 5 instead of 6
+REM The 32/64-bit Windows (pc/x64) and the console (ps3/x360) targets
+REM have the same byte order and version, they share one bin each
+
+CD /D "%~dp0"
+lianzifu.exe ^
+--read-ini "#G3:/ini/loc.ini" ^
+--read-csv ^
+--save-bin ^
+  "x64:6:#X64:/data/compiled/localization/w_strings.bin" ^
+  "ps3:5:#PS3:/data/compiled/localization/x_strings.bin" ^
+--save-map "#G3:/%~n0.csv" ^
+--exit 1> "%~dpn0.log" 2>&1
+
+IF ERRORLEVEL 1 (
+  TYPE "%~dpn0.log"
+  PAUSE
+)
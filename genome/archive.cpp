@@ -20,10 +20,188 @@
 // THE SOFTWARE.
 //
 #include <genome/archive.hpp>
+#include <genome/archive_span.hpp>
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#if GENOME_SIMD_SSE2
+# include <emmintrin.h>
+#endif
+// SSSE3 (pshufb) is not part of x86-64, it is selected at runtime
+#if GENOME_SIMD_SSE2 && !defined(GENOME_NO_SSSE3) && (defined(__clang__) || \
+	(defined(__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9)))) || \
+	(defined(_MSC_VER) && (_MSC_VER >= 1500)))
+# define GENOME_SIMD_SSSE3_RUNTIME 1
+# include <tmmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define GENOME_TARGET_SSSE3
+# else
+#  define GENOME_TARGET_SSSE3 __attribute__((target("ssse3")))
+# endif
+#else
+# define GENOME_SIMD_SSSE3_RUNTIME 0
+#endif
 
 namespace genome {
 
+namespace /*{anonymous}*/ {
+
+//
+// byte order conversion of value arrays
+//
+
+#if GENOME_SIMD_SSSE3_RUNTIME
+
+bool
+cpu_has_ssse3(void)
+{
+# ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 1);
+	return (0 != (info[2] & (1 << 9)));
+# else
+	__builtin_cpu_init();
+	return (0 != __builtin_cpu_supports("ssse3"));
+# endif
+}
+
+bool const have_ssse3 = cpu_has_ssse3();
+
+// returns the number of converted octets (complete 16-octet blocks)
+GENOME_TARGET_SSSE3
+std::size_t
+swap_octets_ssse3(u8 const* src, u8* dst, std::size_t size, unsigned int width)
+{
+	__m128i const mask = (2 == width)
+		? _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)
+		: (4 == width)
+		? _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+		: _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	std::size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(v, mask));
+	}
+	return (i);
+}
+
+#endif
+
+// reverse the octets of each value (src and dst may be the same array)
+
+detail::swap_path const fastest_swap_path =
+#if GENOME_SIMD_SSSE3_RUNTIME
+	have_ssse3 ? detail::swap_path_ssse3 :
+#endif
+#if GENOME_SIMD_SSE2
+	detail::swap_path_sse2;
+#else
+	detail::swap_path_scalar;
+#endif
+
+void
+swap_octets(u16 const* src, u16* dst, std::size_t count)
+{
+	detail::swap_octets(src, dst, count, fastest_swap_path);
+}
+
+void
+swap_octets(u32 const* src, u32* dst, std::size_t count)
+{
+	detail::swap_octets(src, dst, count, fastest_swap_path);
+}
+
+void
+swap_octets(u64 const* src, u64* dst, std::size_t count)
+{
+	std::size_t i = 0;
+#if GENOME_SIMD_SSSE3_RUNTIME
+	if (have_ssse3) {
+		i = swap_octets_ssse3(reinterpret_cast<u8 const*>(src), reinterpret_cast<u8*>(dst), count * sizeof(u64), sizeof(u64)) / sizeof(u64);
+	}
+#endif
+#if GENOME_SIMD_SSE2
+	for (; i + 2 <= count; i += 2) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+#endif
+	for (; i < count; ++i) {
+		u32 const lo = static_cast<u32>(src[i]);
+		u32 const hi = static_cast<u32>(src[i] >> 32);
+		u32 swapped[2];
+		swap_octets(&lo, &swapped[0], 1);
+		swap_octets(&hi, &swapped[1], 1);
+		dst[i] = (static_cast<u64>(swapped[0]) << 32) | swapped[1];
+	}
+}
+
+// converted in chunks (no allocation of the complete array)
+std::size_t const convert_chunk_size = 16384;
+
+template<typename T>
+void
+write_converted(oarchive& archive, T const values[], std::size_t count, archive::byte_order order)
+{
+	T chunk[convert_chunk_size / sizeof(T)];
+	std::size_t const chunk_count = sizeof(chunk) / sizeof(chunk[0]);
+	bool const host_swap = (archive::big_endian == order)
+		? target_integer_little_endian
+		: target_integer_big_endian;
+	for (std::size_t pos = 0; archive && (pos < count); pos += chunk_count) {
+		std::size_t const n = (std::min)(count - pos, chunk_count);
+		if (host_swap) {
+			swap_octets(values + pos, chunk, n);
+		} else if (archive::big_endian == order) {
+			for (std::size_t i = 0; i < n; ++i) {
+				detail::write_big_endian(values[pos + i], reinterpret_cast<u8(&)[sizeof(T)]>(chunk[i]));
+			}
+		} else {
+			for (std::size_t i = 0; i < n; ++i) {
+				detail::write_little_endian(values[pos + i], reinterpret_cast<u8(&)[sizeof(T)]>(chunk[i]));
+			}
+		}
+		archive.write(reinterpret_cast<u8 const*>(chunk), static_cast<archive::streamsize>(n * sizeof(T)));
+	}
+}
+
+template<typename T>
+void
+read_converted(iarchive& archive, T values[], std::size_t count, archive::byte_order order)
+{
+	// read into the array and convert in place
+	std::size_t const size = count * sizeof(T);
+	if (!archive.read(reinterpret_cast<u8*>(&values[0]), static_cast<archive::streamsize>(size))) {
+		std::size_t const end = static_cast<std::size_t>(archive.gcount()) / sizeof(T);
+		for (std::size_t i = end; i < count; ++i) {
+			values[i] = 0;
+		}
+		count = end;
+	}
+	bool const host_swap = (archive::big_endian == order)
+		? target_integer_little_endian
+		: target_integer_big_endian;
+	if (host_swap) {
+		swap_octets(values, values, count);
+	} else {
+		for (std::size_t i = 0; i < count; ++i) {
+			u8 octets[sizeof(T)];
+			std::copy(reinterpret_cast<u8 const*>(&values[i]), reinterpret_cast<u8 const*>(&values[i]) + sizeof(T), octets);
+			if (archive::big_endian == order) {
+				detail::read_big_endian(values[i], octets);
+			} else {
+				detail::read_little_endian(values[i], octets);
+			}
+		}
+	}
+}
+
+} // namespace genome::{anonymous}
+
 //
 // archive
 //
@@ -130,11 +308,28 @@ archive::streamref::valid(void) const
 // archive::header
 //
 
-archive::header::header(iarchive& input)
+namespace detail {
+
+void
+make_archive_header(u8(& data)[8], archive::byte_order endianness)
+{
+	data[0] = 0x47;  // 'G'
+	data[1] = 0x41;  // 'A'
+	data[2] = 0x52;  // 'R'
+	data[3] = 0x35;  // '5'
+	data[4] = static_cast<u8>(
+		(archive::big_endian == endianness)
+		? 0x10
+		: 0x20
+	);
+	data[5] = 0x00;
+	data[6] = 0x00;
+	data[7] = 0x00;
+}
+
+void
+check_archive_header(u8 const(& data)[8])
 {
-	if (!(input >> data)) {
-		throw std::runtime_error("failed to read Genome Archive header");
-	}
 	if ((data[0] != 0x47) ||  // 'G'
 	    (data[1] != 0x41) ||  // 'A'
 	    (data[2] != 0x52)) {  // 'R'
@@ -154,20 +349,97 @@ archive::header::header(iarchive& input)
 	}
 }
 
-archive::header::header(byte_order endianness)
+archive::byte_order
+archive_header_endianness(u8 const(& data)[8])
 {
-	data[0] = 0x47;  // 'G'
-	data[1] = 0x41;  // 'A'
-	data[2] = 0x52;  // 'R'
-	data[3] = 0x35;  // '5'
-	data[4] = static_cast<u8>(
-		(big_endian == endianness)
-		? 0x10
-		: 0x20
+	return (
+		(0x10 & data[4])
+		? archive::big_endian
+		: archive::little_endian
 	);
-	data[5] = 0x00;
-	data[6] = 0x00;
-	data[7] = 0x00;
+}
+
+//
+// byte order conversion of value arrays
+//
+
+bool
+swap_path_supported(swap_path path)
+{
+	switch (path) {
+	case swap_path_scalar:
+		return (true);
+	case swap_path_sse2:
+		return (!!GENOME_SIMD_SSE2);
+	case swap_path_ssse3:
+#if GENOME_SIMD_SSSE3_RUNTIME
+		return (have_ssse3);
+#else
+		return (false);
+#endif
+	}
+	return (false);
+}
+
+void
+swap_octets(u16 const src[], u16 dst[], std::size_t count, swap_path path)
+{
+	std::size_t i = 0;
+#if GENOME_SIMD_SSSE3_RUNTIME
+	if ((swap_path_ssse3 == path) && have_ssse3) {
+		i = swap_octets_ssse3(reinterpret_cast<u8 const*>(src), reinterpret_cast<u8*>(dst), count * sizeof(u16), sizeof(u16)) / sizeof(u16);
+	}
+#endif
+#if GENOME_SIMD_SSE2
+	for (; (swap_path_scalar != path) && (i + 8 <= count); i += 8) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+#endif
+	for (; i < count; ++i) {
+		u16 const v = src[i];
+		dst[i] = static_cast<u16>((v << 8) | (v >> 8));
+	}
+}
+
+void
+swap_octets(u32 const src[], u32 dst[], std::size_t count, swap_path path)
+{
+	std::size_t i = 0;
+#if GENOME_SIMD_SSSE3_RUNTIME
+	if ((swap_path_ssse3 == path) && have_ssse3) {
+		i = swap_octets_ssse3(reinterpret_cast<u8 const*>(src), reinterpret_cast<u8*>(dst), count * sizeof(u32), sizeof(u32)) / sizeof(u32);
+	}
+#endif
+#if GENOME_SIMD_SSE2
+	for (; (swap_path_scalar != path) && (i + 4 <= count); i += 4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+	}
+#endif
+	for (; i < count; ++i) {
+		u32 const v = src[i];
+		dst[i] = (v << 24) | ((v << 8) & 0x00FF0000UL) | ((v >> 8) & 0x0000FF00UL) | (v >> 24);
+	}
+}
+
+} // namespace genome::detail
+
+archive::header::header(iarchive& input)
+{
+	if (!(input >> data)) {
+		throw std::runtime_error("failed to read Genome Archive header");
+	}
+	detail::check_archive_header(data);
+}
+
+archive::header::header(byte_order endianness)
+{
+	detail::make_archive_header(data, endianness);
 }
 
 oarchive&
@@ -179,11 +451,7 @@ archive::header::write(oarchive& output)
 archive::byte_order
 archive::header::endianness(void) const
 {
-	return (
-		(0x10 & data[4])
-		? big_endian
-		: little_endian
-	);
+	return (detail::archive_header_endianness(data));
 }
 
 //
@@ -220,18 +488,7 @@ iarchive::read(u16 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_big_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
@@ -243,18 +500,7 @@ iarchive::read(u16 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_little_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -289,18 +535,7 @@ iarchive::read(u32 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_big_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
@@ -312,18 +547,7 @@ iarchive::read(u32 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_little_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -358,18 +582,7 @@ iarchive::read(u64 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_big_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
@@ -381,18 +594,7 @@ iarchive::read(u64 values[], streamsize count)
 					}
 				}
 			} else {
-				std::vector<u8> octets(size);
-				if (!read(&octets[0], static_cast<streamsize>(size))) {
-					streamsize end = gcount() / static_cast<streamsize>(sizeof(values[0]));
-					for (streamsize i = end; i < count; ++i) {
-						values[i] = 0;
-					}
-					count = end;
-				}
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::read_little_endian(values[i],
-						reinterpret_cast<u8 const(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
+				read_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -572,24 +774,14 @@ oarchive::write(u16 const values[], streamsize count)
 			if (target_integer_big_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_big_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
 			if (target_integer_little_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_little_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -619,24 +811,14 @@ oarchive::write(u32 const values[], streamsize count)
 			if (target_integer_big_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_big_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
 			if (target_integer_little_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_little_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -666,24 +848,14 @@ oarchive::write(u64 const values[], streamsize count)
 			if (target_integer_big_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_big_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), big_endian);
 			}
 			break;
 		case little_endian:
 			if (target_integer_little_endian) {
 				write(reinterpret_cast<u8 const*>(&values[0]), static_cast<streamsize>(size));
 			} else {
-				std::vector<u8> octets(size);
-				for (std::size_t i = 0; i < static_cast<std::size_t>(count); ++i) {
-					detail::write_little_endian(values[i],
-						reinterpret_cast<u8(&)[sizeof(values[0])]>(octets[i * sizeof(values[0])]));
-				}
-				write(&octets[0], static_cast<streamsize>(size));
+				write_converted(*this, values, size / sizeof(values[0]), little_endian);
 			}
 			break;
 		}
@@ -946,4 +1118,194 @@ onarchive::ref_end(streamref& ref) const
 	}
 }
 
+//
+// imarchive
+//
+
+imarchive::imarchive(u8 const* data, std::size_t size)
+	: m_except(std::ios_base::goodbit), m_span(data, size)
+{
+}
+
+imarchive::imarchive(std::vector<u8> const& data)
+	: m_except(std::ios_base::goodbit), m_span(data)
+{
+}
+
+bool
+imarchive::operator_bool(void) const
+{
+	return (!m_span.fail());
+}
+
+bool
+imarchive::operator!(void) const
+{
+	return (m_span.fail());
+}
+
+std::ios_base::iostate
+imarchive::rdstate(void) const
+{
+	return (m_span.rdstate());
+}
+
+void
+imarchive::setstate(std::ios_base::iostate state)
+{
+	clear(m_span.rdstate() | state);
+}
+
+void
+imarchive::clear(std::ios_base::iostate state)
+{
+	m_span.clear(state);
+	if ((m_except & state) != 0) {
+		throw std::ios_base::failure("memory stream error");
+	}
+}
+
+std::ios_base::iostate
+imarchive::exceptions(void) const
+{
+	return(m_except);
+}
+
+void
+imarchive::exceptions(std::ios_base::iostate except)
+{
+	m_except = except;
+	clear(m_span.rdstate());
+}
+
+archive::byte_order
+imarchive::endianness(void) const
+{
+	return (m_span.header_endianness());
+}
+
+archive::streampos
+imarchive::tellg(void)
+{
+	return (m_span.tellg());
+}
+
+imarchive&
+imarchive::seekg(streampos pos)
+{
+	clear(m_span.seekg(pos).rdstate());
+	return (*this);
+}
+
+imarchive&
+imarchive::read_octets(u8* values, streamsize count)
+{
+	clear(m_span.read_octets(values, count).rdstate());
+	return (*this);
+}
+
+archive::streamsize
+imarchive::gcount(void) const
+{
+	return (m_span.gcount());
+}
+
+//
+// omarchive
+//
+
+omarchive::omarchive(byte_order endianness)
+	: m_except(std::ios_base::goodbit), m_data(), m_buffer(m_data, endianness)
+{
+}
+
+omarchive::omarchive(platform target)
+	: m_except(std::ios_base::goodbit), m_data(), m_buffer(m_data, platform_endianess(target))
+{
+}
+
+bool
+omarchive::operator_bool(void) const
+{
+	return (!m_buffer.fail());
+}
+
+bool
+omarchive::operator!(void) const
+{
+	return (m_buffer.fail());
+}
+
+std::ios_base::iostate
+omarchive::rdstate(void) const
+{
+	return (m_buffer.rdstate());
+}
+
+void
+omarchive::setstate(std::ios_base::iostate state)
+{
+	clear(m_buffer.rdstate() | state);
+}
+
+void
+omarchive::clear(std::ios_base::iostate state)
+{
+	m_buffer.clear(state);
+	if ((m_except & state) != 0) {
+		throw std::ios_base::failure("memory stream error");
+	}
+}
+
+std::ios_base::iostate
+omarchive::exceptions(void) const
+{
+	return(m_except);
+}
+
+void
+omarchive::exceptions(std::ios_base::iostate except)
+{
+	m_except = except;
+	clear(m_buffer.rdstate());
+}
+
+archive::byte_order
+omarchive::endianness(void) const
+{
+	return (m_buffer.header_endianness());
+}
+
+archive::streampos
+omarchive::tellp(void) const
+{
+	return (m_buffer.tellp());
+}
+
+omarchive&
+omarchive::seekp(streampos pos)
+{
+	clear(m_buffer.seekp(pos).rdstate());
+	return (*this);
+}
+
+omarchive&
+omarchive::write_octets(u8 const* values, streamsize count)
+{
+	clear(m_buffer.write_octets(values, count).rdstate());
+	return (*this);
+}
+
+std::vector<u8> const&
+omarchive::data(void) const
+{
+	return (m_data);
+}
+
+std::vector<u8>&
+omarchive::data(void)
+{
+	return (m_data);
+}
+
 } // namespace genome
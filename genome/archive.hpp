@@ -114,6 +114,23 @@ bool operator!=(archive const& lhs, T const& rhs);
 template<typename T>
 bool operator==(archive const& lhs, T const& rhs);
 
+namespace detail {
+// Genome Archive header octets (shared with the archive_span templates)
+void make_archive_header(u8(& data)[8], archive::byte_order endianness);
+void check_archive_header(u8 const(& data)[8]);  // throws if invalid/unsupported
+archive::byte_order archive_header_endianness(u8 const(& data)[8]);
+// byte order conversion of value arrays with a fixed code path (the archives
+// use the fastest supported one, the others are compared by lianzifu_bench)
+enum swap_path {
+	swap_path_scalar,
+	swap_path_sse2,
+	swap_path_ssse3  // runtime CPU detection
+};
+bool swap_path_supported(swap_path path);
+void swap_octets(u16 const src[], u16 dst[], std::size_t count, swap_path path);  // src and dst may be the same array
+void swap_octets(u32 const src[], u32 dst[], std::size_t count, swap_path path);
+} // namespace genome::detail
+
 class iarchive : public archive {  // virtual inheritance if ioarchive is introduced
 public:
 	virtual streampos tellg(void) = 0;
@@ -0,0 +1,271 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_ARCHIVE_SPAN_HPP
+#define GENOME_ARCHIVE_SPAN_HPP
+
+#include <genome/genome.hpp>
+#include <genome/archive.hpp>
+#include <genome/string.hpp>
+#include <genome/time.hpp>
+#include <vector>
+
+//
+// Non-virtual archives with the byte order as template argument.
+//
+// - the byte order conversion is resolved at compile time
+//   (no endianness() switch and no virtual call per field)
+// - the data is a complete Genome Archive image in memory
+//   (including the header, stream positions are image offsets)
+// - NO exceptions() support (state flags only)
+//
+// The octet access does not depend on the byte order, it is shared with the
+// virtual imarchive/omarchive adapters (byte order selected at runtime).
+//
+
+namespace genome {
+
+template<archive::byte_order Order>
+struct archive_codec {
+	// values are stored in the target byte order (plain copy)
+	static GENOME_CONSTEXPR_CONST bool native = (archive::big_endian == Order)
+		? bool(target_integer_big_endian)
+		: bool(target_integer_little_endian);
+	template<typename T>
+	static void load(T& value, u8 const* octets);
+	template<typename T>
+	static void store(T const& value, u8* octets);
+	// convert count values in place (values still hold the archive octets)
+	template<typename T>
+	static void convert(T values[], std::size_t count);
+};
+
+class iarchive_span_base {
+public:
+	typedef archive::streampos streampos;
+	typedef archive::streamsize streamsize;
+	iarchive_span_base(u8 const* data, std::size_t size);  // throws on invalid header
+	explicit iarchive_span_base(std::vector<u8> const& data);
+	std::ios_base::iostate rdstate(void) const;
+	void setstate(std::ios_base::iostate state);
+	void clear(std::ios_base::iostate state = std::ios_base::goodbit);
+	bool good(void) const;
+	bool eof(void) const;
+	bool fail(void) const;
+	bool bad(void) const;
+	archive::byte_order header_endianness(void) const;
+	streampos tellg(void) const;
+	iarchive_span_base& seekg(streampos pos);
+	iarchive_span_base& read_octets(u8* values, streamsize count);
+	streamsize gcount(void) const;
+protected:
+	u8 const* m_data;
+	streamsize m_size;
+	streampos m_pos;
+	streamsize m_gcount;
+	std::ios_base::iostate m_state;
+private:
+	void init(std::size_t size);
+	archive::byte_order m_endianness;
+};
+
+template<archive::byte_order Order>
+class iarchive_span : public iarchive_span_base {
+	void does_not_support_comparisons(void) const;
+public:
+	typedef void (iarchive_span::*bool_type)(void) const;
+	iarchive_span(u8 const* data, std::size_t size);  // throws on invalid header
+	explicit iarchive_span(std::vector<u8> const& data);
+	operator bool_type(void) const;
+	bool operator!(void) const;
+	static archive::byte_order endianness(void);
+	iarchive_span& seekg(streampos pos);
+	iarchive_span& read_octets(u8* values, streamsize count);
+	template<typename T>
+	iarchive_span& read(T values[], streamsize count);
+	iarchive_span& read(archive::streamref values[], streamsize count);
+	template<typename T>
+	iarchive_span& read(std::vector<T>& values, streamsize count);
+	template<typename T>
+	iarchive_span& read_value(T& value);
+private:
+	void check_endianness(void) const;
+};
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, u8& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, i8& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, u16& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, i16& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, u32& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, i32& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, u64& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, i64& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, archive::streamref& value);
+template<archive::byte_order Order, typename T, std::size_t N>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, T(& values)[N]);
+// same encoding as operator>>(iarchive&, byte_string&) and (iarchive&, datetime&)
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, byte_string& value);
+template<archive::byte_order Order>
+iarchive_span<Order>& operator>>(iarchive_span<Order>& archive, datetime& value);
+
+class oarchive_buffer_base {
+	oarchive_buffer_base(oarchive_buffer_base const&) GENOME_DELETE_FUNCTION;
+	oarchive_buffer_base& operator=(oarchive_buffer_base const&) GENOME_DELETE_FUNCTION;
+public:
+	typedef archive::streampos streampos;
+	typedef archive::streamsize streamsize;
+	oarchive_buffer_base(std::vector<u8>& data, archive::byte_order endianness);  // replaces the content with the header
+	std::ios_base::iostate rdstate(void) const;
+	void setstate(std::ios_base::iostate state);
+	void clear(std::ios_base::iostate state = std::ios_base::goodbit);
+	bool good(void) const;
+	bool eof(void) const;
+	bool fail(void) const;
+	bool bad(void) const;
+	archive::byte_order header_endianness(void) const;
+	streampos tellp(void) const;
+	oarchive_buffer_base& seekp(streampos pos);
+	oarchive_buffer_base& write_octets(u8 const* values, streamsize count);
+	std::vector<u8>& data(void);
+protected:
+	std::vector<u8>& m_data;
+	streampos m_pos;
+	std::ios_base::iostate m_state;
+private:
+	archive::byte_order m_endianness;
+};
+
+template<archive::byte_order Order>
+class oarchive_buffer : public oarchive_buffer_base {
+	oarchive_buffer(oarchive_buffer const&) GENOME_DELETE_FUNCTION;
+	oarchive_buffer& operator=(oarchive_buffer const&) GENOME_DELETE_FUNCTION;
+	void does_not_support_comparisons(void) const;
+public:
+	typedef void (oarchive_buffer::*bool_type)(void) const;
+	explicit oarchive_buffer(std::vector<u8>& data);  // replaces the content with the header
+	operator bool_type(void) const;
+	bool operator!(void) const;
+	static archive::byte_order endianness(void);
+	oarchive_buffer& seekp(streampos pos);
+	oarchive_buffer& write_octets(u8 const* values, streamsize count);
+	template<typename T>
+	oarchive_buffer& write(T const values[], streamsize count);
+	oarchive_buffer& write(archive::streamref const values[], streamsize count);
+	template<typename T>
+	oarchive_buffer& write(std::vector<T> const& values);
+	template<typename T>
+	oarchive_buffer& write_value(T const& value);
+};
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, u8 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, i8 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, u16 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, i16 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, u32 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, i32 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, u64 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, i64 const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, archive::streamref const& value);
+template<archive::byte_order Order, typename T, std::size_t N>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, T const(& values)[N]);
+template<archive::byte_order Order, typename T>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, std::vector<T> const& values);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, byte_string const& value);
+template<archive::byte_order Order>
+oarchive_buffer<Order>& operator<<(oarchive_buffer<Order>& archive, datetime const& value);
+
+//
+// Virtual archives over the spans (byte order from the header/argument).
+//
+
+// archive image in memory (the data must outlive the archive)
+class imarchive : public iarchive {
+	imarchive(imarchive const&) GENOME_DELETE_FUNCTION;
+	imarchive& operator=(imarchive const&) GENOME_DELETE_FUNCTION;
+public:
+	imarchive(u8 const* data, std::size_t size);
+	explicit imarchive(std::vector<u8> const& data);
+	virtual bool operator_bool(void) const GENOME_OVERRIDE;
+	virtual bool operator!(void) const GENOME_OVERRIDE;
+	virtual std::ios_base::iostate rdstate(void) const GENOME_OVERRIDE;
+	virtual void setstate(std::ios_base::iostate state) GENOME_OVERRIDE;
+	virtual void clear(std::ios_base::iostate state = std::ios_base::goodbit) GENOME_OVERRIDE;
+	virtual std::ios_base::iostate exceptions(void) const GENOME_OVERRIDE;
+	virtual void exceptions(std::ios_base::iostate except) GENOME_OVERRIDE;
+	virtual byte_order endianness(void) const GENOME_OVERRIDE;
+	virtual streampos tellg(void) GENOME_OVERRIDE;
+	virtual imarchive& seekg(streampos pos) GENOME_OVERRIDE;
+	virtual imarchive& read_octets(u8* values, streamsize count) GENOME_OVERRIDE;
+	virtual streamsize gcount(void) const GENOME_OVERRIDE;
+private:
+	std::ios_base::iostate m_except;
+	iarchive_span_base m_span;
+};
+
+// growable archive image in memory (positions after the end are zero-filled)
+class omarchive : public oarchive {
+	omarchive(omarchive const&) GENOME_DELETE_FUNCTION;
+	omarchive& operator=(omarchive const&) GENOME_DELETE_FUNCTION;
+public:
+	explicit omarchive(byte_order endianness);
+	explicit omarchive(platform target);
+	virtual bool operator_bool(void) const GENOME_OVERRIDE;
+	virtual bool operator!(void) const GENOME_OVERRIDE;
+	virtual std::ios_base::iostate rdstate(void) const GENOME_OVERRIDE;
+	virtual void setstate(std::ios_base::iostate state) GENOME_OVERRIDE;
+	virtual void clear(std::ios_base::iostate state = std::ios_base::goodbit) GENOME_OVERRIDE;
+	virtual std::ios_base::iostate exceptions(void) const GENOME_OVERRIDE;
+	virtual void exceptions(std::ios_base::iostate except) GENOME_OVERRIDE;
+	virtual byte_order endianness(void) const GENOME_OVERRIDE;
+	virtual streampos tellp(void) const GENOME_OVERRIDE;
+	virtual omarchive& seekp(streampos pos) GENOME_OVERRIDE;
+	virtual omarchive& write_octets(u8 const* values, streamsize count) GENOME_OVERRIDE;
+	std::vector<u8> const& data(void) const;  // complete image (including the header)
+	std::vector<u8>& data(void);
+private:
+	std::ios_base::iostate m_except;
+	std::vector<u8> m_data;
+	oarchive_buffer_base m_buffer;
+};
+
+} // namespace genome
+
+#include <genome/archive_span.ipp>
+
+#endif // GENOME_ARCHIVE_SPAN_HPP
@@ -0,0 +1,801 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_ARCHIVE_SPAN_IPP
+#define GENOME_ARCHIVE_SPAN_IPP
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace genome {
+
+//
+// archive_codec
+//
+
+template<archive::byte_order Order>
+template<typename T>
+void
+archive_codec<Order>::load(T& value, u8 const* octets)
+{
+	if (native) {
+		std::memcpy(&value, octets, sizeof(T));
+	} else {
+		T n = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i) {
+			n = static_cast<T>((n << 8) | octets[(archive::big_endian == Order) ? i : (sizeof(T) - 1 - i)]);
+		}
+		value = n;
+	}
+}
+
+template<archive::byte_order Order>
+template<typename T>
+void
+archive_codec<Order>::store(T const& value, u8* octets)
+{
+	if (native) {
+		std::memcpy(octets, &value, sizeof(T));
+	} else {
+		T n = value;
+		for (std::size_t i = 0; i < sizeof(T); ++i) {
+			octets[(archive::big_endian == Order) ? (sizeof(T) - 1 - i) : i] = static_cast<u8>(n & 0xFF);
+			n = static_cast<T>(n >> 8);
+		}
+	}
+}
+
+template<archive::byte_order Order>
+template<typename T>
+void
+archive_codec<Order>::convert(T values[], std::size_t count)
+{
+	if (!native) {
+		for (std::size_t i = 0; i < count; ++i) {
+			u8 octets[sizeof(T)];
+			std::memcpy(octets, &values[i], sizeof(T));
+			load(values[i], octets);
+		}
+	}
+}
+
+//
+// iarchive_span_base
+//
+
+inline
+iarchive_span_base::iarchive_span_base(u8 const* data, std::size_t size)
+	: m_data(data)
+	, m_size(0)
+	, m_pos(0)
+	, m_gcount(0)
+	, m_state(std::ios_base::goodbit)
+	, m_endianness(archive::little_endian)
+{
+	init(size);
+}
+
+inline
+iarchive_span_base::iarchive_span_base(std::vector<u8> const& data)
+	: m_data(data.empty() ? 0 : &data[0])
+	, m_size(0)
+	, m_pos(0)
+	, m_gcount(0)
+	, m_state(std::ios_base::goodbit)
+	, m_endianness(archive::little_endian)
+{
+	init(data.size());
+}
+
+inline
+void
+iarchive_span_base::init(std::size_t size)
+{
+	if (size > archive::streamsize_limits<u8>::max_size()) {
+		throw std::invalid_argument("Genome Archive image too large");
+	}
+	m_size = static_cast<streamsize>(size);
+	u8 header[8];
+	if (!read_octets(header, sizeof(header)).good()) {
+		throw std::runtime_error("failed to read Genome Archive header");
+	}
+	detail::check_archive_header(header);
+	m_endianness = detail::archive_header_endianness(header);
+}
+
+inline
+std::ios_base::iostate
+iarchive_span_base::rdstate(void) const
+{
+	return (m_state);
+}
+
+inline
+void
+iarchive_span_base::setstate(std::ios_base::iostate state)
+{
+	m_state |= state;
+}
+
+inline
+void
+iarchive_span_base::clear(std::ios_base::iostate state)
+{
+	m_state = state;
+}
+
+inline
+bool
+iarchive_span_base::good(void) const
+{
+	return (std::ios_base::goodbit == m_state);
+}
+
+inline
+bool
+iarchive_span_base::eof(void) const
+{
+	return ((std::ios_base::eofbit & m_state) != 0);
+}
+
+inline
+bool
+iarchive_span_base::fail(void) const
+{
+	return (((std::ios_base::failbit | std::ios_base::badbit) & m_state) != 0);
+}
+
+inline
+bool
+iarchive_span_base::bad(void) const
+{
+	return ((std::ios_base::badbit & m_state) != 0);
+}
+
+inline
+archive::byte_order
+iarchive_span_base::header_endianness(void) const
+{
+	return (m_endianness);
+}
+
+inline
+archive::streampos
+iarchive_span_base::tellg(void) const
+{
+	return (fail() ? streampos(-1) : m_pos);
+}
+
+inline
+iarchive_span_base&
+iarchive_span_base::seekg(streampos pos)
+{
+	m_state &= ~std::ios_base::eofbit;
+	if (!fail()) {
+		if ((pos < static_cast<streampos>(sizeof(u8[8]))) || (pos > m_size)) {
+			setstate(std::ios_base::failbit);
+		} else {
+			m_pos = pos;
+		}
+	}
+	return (*this);
+}
+
+inline
+iarchive_span_base&
+iarchive_span_base::read_octets(u8* values, streamsize count)
+{
+	m_gcount = 0;
+	if (count > 0) {
+		if (!values) {
+			setstate(std::ios_base::failbit);
+			return (*this);
+		}
+		if (good()) {
+			m_gcount = std::min<streamsize>(count, m_size - m_pos);
+			if (m_gcount > 0) {
+				std::memcpy(values, m_data + m_pos, m_gcount);
+				m_pos += m_gcount;
+			}
+		}
+		if (m_gcount < count) {
+			std::memset(values + m_gcount, 0, count - m_gcount);
+			setstate(good() ? (std::ios_base::eofbit | std::ios_base::failbit) : std::ios_base::failbit);
+		}
+	}
+	return (*this);
+}
+
+inline
+archive::streamsize
+iarchive_span_base::gcount(void) const
+{
+	return (m_gcount);
+}
+
+//
+// iarchive_span
+//
+
+template<archive::byte_order Order>
+void
+iarchive_span<Order>::does_not_support_comparisons(void) const
+{
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>::iarchive_span(u8 const* data, std::size_t size)
+	: iarchive_span_base(data, size)
+{
+	check_endianness();
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>::iarchive_span(std::vector<u8> const& data)
+	: iarchive_span_base(data)
+{
+	check_endianness();
+}
+
+template<archive::byte_order Order>
+void
+iarchive_span<Order>::check_endianness(void) const
+{
+	if (header_endianness() != Order) {
+		throw std::invalid_argument("unexpected Genome Archive endianness");
+	}
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>::operator bool_type(void) const
+{
+	return (
+		!fail()
+		? &iarchive_span::does_not_support_comparisons
+		: 0
+	);
+}
+
+template<archive::byte_order Order>
+bool
+iarchive_span<Order>::operator!(void) const
+{
+	return (fail());
+}
+
+template<archive::byte_order Order>
+archive::byte_order
+iarchive_span<Order>::endianness(void)
+{
+	return (Order);
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+iarchive_span<Order>::seekg(streampos pos)
+{
+	iarchive_span_base::seekg(pos);
+	return (*this);
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+iarchive_span<Order>::read_octets(u8* values, streamsize count)
+{
+	iarchive_span_base::read_octets(values, count);
+	return (*this);
+}
+
+template<archive::byte_order Order>
+template<typename T>
+iarchive_span<Order>&
+iarchive_span<Order>::read(T values[], streamsize count)
+{
+	if (count > archive::streamsize_limits<T>::max_count()) {
+		setstate(std::ios_base::failbit);
+	} else if (count > 0) {
+		read_octets(reinterpret_cast<u8*>(values), static_cast<streamsize>(count * sizeof(T)));
+		// partially read values are zeroed like the missing ones
+		std::size_t const done = static_cast<std::size_t>(m_gcount / sizeof(T));
+		std::memset(&values[done], 0, (count - done) * sizeof(T));
+		archive_codec<Order>::convert(values, done);
+	}
+	return (*this);
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+iarchive_span<Order>::read(archive::streamref values[], streamsize count)
+{
+	if (count > archive::streamsize_limits<archive::streamref>::max_count()) {
+		setstate(std::ios_base::failbit);
+		return (*this);
+	}
+	return (read(reinterpret_cast<u32*>(values), static_cast<streamsize>(count * 2)));
+}
+
+template<archive::byte_order Order>
+template<typename T>
+iarchive_span<Order>&
+iarchive_span<Order>::read(std::vector<T>& values, streamsize count)
+{
+	values.clear();
+	if (count > 0) {
+		// never allocate more values than the image can hold
+		streamsize const avail = good() ? static_cast<streamsize>((m_size - m_pos) / sizeof(T)) : 0;
+		streamsize const size = std::min(count, avail);
+		values.resize(static_cast<std::size_t>(size));
+		if (size > 0) {
+			read(&values[0], size);
+		}
+		if (size < count) {
+			setstate(good() ? (std::ios_base::eofbit | std::ios_base::failbit) : std::ios_base::failbit);
+		}
+	}
+	return (*this);
+}
+
+template<archive::byte_order Order>
+template<typename T>
+iarchive_span<Order>&
+iarchive_span<Order>::read_value(T& value)
+{
+	u8 octets[sizeof(T)];
+	read_octets(octets, sizeof(octets));
+	archive_codec<Order>::load(value, octets);
+	return (*this);
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, u8& value)
+{
+	return (archive.read_value(value));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, i8& value)
+{
+	return (archive.read_value(reinterpret_cast<u8&>(value)));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, u16& value)
+{
+	return (archive.read_value(value));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, i16& value)
+{
+	return (archive.read_value(reinterpret_cast<u16&>(value)));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, u32& value)
+{
+	return (archive.read_value(value));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, i32& value)
+{
+	return (archive.read_value(reinterpret_cast<u32&>(value)));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, u64& value)
+{
+	return (archive.read_value(value));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, i64& value)
+{
+	return (archive.read_value(reinterpret_cast<u64&>(value)));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, archive::streamref& value)
+{
+	return (archive.read(&value, 1));
+}
+
+template<archive::byte_order Order, typename T, std::size_t N>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, T(& values)[N])
+{
+	return (archive.read(values, N));
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, byte_string& value)
+{
+	u16 size = 0;
+	archive >> size;
+	value.resize(size);
+	if (size) {
+		if (!archive.read(&value[0], size)) {
+			value.resize(static_cast<byte_string::size_type>(archive.gcount()));
+		}
+	}
+	return (archive);
+}
+
+template<archive::byte_order Order>
+iarchive_span<Order>&
+operator>>(iarchive_span<Order>& archive, datetime& value)
+{
+	u32 ticks[2];
+	archive >> ticks;
+	value = datetime((static_cast<u64>(ticks[0]) << 32) | ticks[1]);
+	return (archive);
+}
+
+//
+// oarchive_buffer_base
+//
+
+inline
+oarchive_buffer_base::oarchive_buffer_base(std::vector<u8>& data, archive::byte_order endianness)
+	: m_data(data)
+	, m_pos(0)
+	, m_state(std::ios_base::goodbit)
+	, m_endianness(endianness)
+{
+	u8 header[8];
+	detail::make_archive_header(header, m_endianness);
+	m_data.clear();
+	write_octets(header, sizeof(header));
+}
+
+inline
+std::ios_base::iostate
+oarchive_buffer_base::rdstate(void) const
+{
+	return (m_state);
+}
+
+inline
+void
+oarchive_buffer_base::setstate(std::ios_base::iostate state)
+{
+	m_state |= state;
+}
+
+inline
+void
+oarchive_buffer_base::clear(std::ios_base::iostate state)
+{
+	m_state = state;
+}
+
+inline
+bool
+oarchive_buffer_base::good(void) const
+{
+	return (std::ios_base::goodbit == m_state);
+}
+
+inline
+bool
+oarchive_buffer_base::eof(void) const
+{
+	return ((std::ios_base::eofbit & m_state) != 0);
+}
+
+inline
+bool
+oarchive_buffer_base::fail(void) const
+{
+	return (((std::ios_base::failbit | std::ios_base::badbit) & m_state) != 0);
+}
+
+inline
+bool
+oarchive_buffer_base::bad(void) const
+{
+	return ((std::ios_base::badbit & m_state) != 0);
+}
+
+inline
+archive::byte_order
+oarchive_buffer_base::header_endianness(void) const
+{
+	return (m_endianness);
+}
+
+inline
+archive::streampos
+oarchive_buffer_base::tellp(void) const
+{
+	return (fail() ? streampos(-1) : m_pos);
+}
+
+inline
+oarchive_buffer_base&
+oarchive_buffer_base::seekp(streampos pos)
+{
+	// positions after the end are allowed (the gap is zero-filled on write)
+	if (!fail()) {
+		if (pos < static_cast<streampos>(sizeof(u8[8]))) {
+			setstate(std::ios_base::failbit);
+		} else {
+			m_pos = pos;
+		}
+	}
+	return (*this);
+}
+
+inline
+oarchive_buffer_base&
+oarchive_buffer_base::write_octets(u8 const* values, streamsize count)
+{
+	if ((count > 0) && good()) {
+		streampos const end = m_pos + count;
+		if (!values || (m_pos > end)) {
+			setstate(std::ios_base::failbit);
+		} else {
+			if (end > m_data.size()) {
+				m_data.resize(end);
+			}
+			std::memcpy(&m_data[m_pos], values, count);
+			m_pos = end;
+		}
+	}
+	return (*this);
+}
+
+inline
+std::vector<u8>&
+oarchive_buffer_base::data(void)
+{
+	return (m_data);
+}
+
+//
+// oarchive_buffer
+//
+
+template<archive::byte_order Order>
+void
+oarchive_buffer<Order>::does_not_support_comparisons(void) const
+{
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>::oarchive_buffer(std::vector<u8>& data)
+	: oarchive_buffer_base(data, Order)
+{
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>::operator bool_type(void) const
+{
+	return (
+		!fail()
+		? &oarchive_buffer::does_not_support_comparisons
+		: 0
+	);
+}
+
+template<archive::byte_order Order>
+bool
+oarchive_buffer<Order>::operator!(void) const
+{
+	return (fail());
+}
+
+template<archive::byte_order Order>
+archive::byte_order
+oarchive_buffer<Order>::endianness(void)
+{
+	return (Order);
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::seekp(streampos pos)
+{
+	oarchive_buffer_base::seekp(pos);
+	return (*this);
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::write_octets(u8 const* values, streamsize count)
+{
+	oarchive_buffer_base::write_octets(values, count);
+	return (*this);
+}
+
+template<archive::byte_order Order>
+template<typename T>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::write(T const values[], streamsize count)
+{
+	if (count > archive::streamsize_limits<T>::max_count()) {
+		setstate(std::ios_base::failbit);
+	} else if (count > 0) {
+		streampos const pos = m_pos;
+		write_octets(reinterpret_cast<u8 const*>(values), static_cast<streamsize>(count * sizeof(T)));
+		if (!archive_codec<Order>::native && good()) {
+			for (streamsize i = 0; i < count; ++i) {
+				archive_codec<Order>::store(values[i], &m_data[pos + i * sizeof(T)]);
+			}
+		}
+	}
+	return (*this);
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::write(archive::streamref const values[], streamsize count)
+{
+	if (count > archive::streamsize_limits<archive::streamref>::max_count()) {
+		setstate(std::ios_base::failbit);
+		return (*this);
+	}
+	return (write(reinterpret_cast<u32 const*>(values), static_cast<streamsize>(count * 2)));
+}
+
+template<archive::byte_order Order>
+template<typename T>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::write(std::vector<T> const& values)
+{
+	if (values.size() > archive::streamsize_limits<T>::max_count()) {
+		setstate(std::ios_base::failbit);
+	} else if (!values.empty()) {
+		write(&values[0], static_cast<streamsize>(values.size()));
+	}
+	return (*this);
+}
+
+template<archive::byte_order Order>
+template<typename T>
+oarchive_buffer<Order>&
+oarchive_buffer<Order>::write_value(T const& value)
+{
+	u8 octets[sizeof(T)];
+	archive_codec<Order>::store(value, octets);
+	return (write_octets(octets, sizeof(octets)));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, u8 const& value)
+{
+	return (archive.write_value(value));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, i8 const& value)
+{
+	return (archive.write_value(reinterpret_cast<u8 const&>(value)));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, u16 const& value)
+{
+	return (archive.write_value(value));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, i16 const& value)
+{
+	return (archive.write_value(reinterpret_cast<u16 const&>(value)));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, u32 const& value)
+{
+	return (archive.write_value(value));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, i32 const& value)
+{
+	return (archive.write_value(reinterpret_cast<u32 const&>(value)));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, u64 const& value)
+{
+	return (archive.write_value(value));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, i64 const& value)
+{
+	return (archive.write_value(reinterpret_cast<u64 const&>(value)));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, archive::streamref const& value)
+{
+	return (archive.write(&value, 1));
+}
+
+template<archive::byte_order Order, typename T, std::size_t N>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, T const(& values)[N])
+{
+	return (archive.write(values, N));
+}
+
+template<archive::byte_order Order, typename T>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, std::vector<T> const& values)
+{
+	return (archive.write(values));
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, byte_string const& value)
+{
+	byte_string::size_type length = value.length();
+	if (length > u16(-1)) {
+		archive.setstate(std::ios_base::failbit);
+	} else {
+		u16 size = static_cast<u16>(length);
+		archive << size;
+		if (size) {
+			archive.write(value.c_str(), size);
+		}
+	}
+	return (archive);
+}
+
+template<archive::byte_order Order>
+oarchive_buffer<Order>&
+operator<<(oarchive_buffer<Order>& archive, datetime const& value)
+{
+	u32 ticks[2] = {
+		static_cast<u32>(value.ticks() >> 32),
+		static_cast<u32>(value.ticks())
+	};
+	archive << ticks;
+	return (archive);
+}
+
+} // namespace genome
+
+#endif // GENOME_ARCHIVE_SPAN_IPP
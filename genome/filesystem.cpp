@@ -23,11 +23,14 @@
 #include <genome/string.hpp>
 #include <cctype>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <algorithm>
+#include <fstream>
 #include <map>
 #include <utility>
+#include <vector>
 
 #ifndef GENOME_TARGET_PATH_DELIMITER
 # ifdef _WIN32
@@ -71,11 +74,63 @@
 # define mkdir(P, M) _mkdir(P)
 #endif
 
+// getcwd(char*, size_t)
+// getpid(void)
+#if !!GENOME_HAVE_DIRECT_H
+# include <process.h>
+# define getcwd _getcwd
+# define getpid _getpid
+#else
+# include <unistd.h>
+#endif
+
+#if !!GENOME_CXX11
+# include <atomic>
+#endif
+
+// MoveFileExA(char const*, char const*, DWORD)
+#ifndef GENOME_HAVE_MOVEFILEEX
+# ifdef _WIN32
+#  define GENOME_HAVE_MOVEFILEEX 1
+# else
+#  define GENOME_HAVE_MOVEFILEEX 0
+# endif
+#endif
+// FindFirstFileA(char const*, WIN32_FIND_DATAA*)
+// opendir(char const*)
+#ifndef GENOME_HAVE_FINDFIRSTFILE
+# ifdef _WIN32
+#  define GENOME_HAVE_FINDFIRSTFILE 1
+# else
+#  define GENOME_HAVE_FINDFIRSTFILE 0
+# endif
+#endif
+#if !GENOME_HAVE_FINDFIRSTFILE
+# include <dirent.h>
+#endif
+
+#if !!GENOME_HAVE_MOVEFILEEX || !!GENOME_HAVE_FINDFIRSTFILE
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#endif
+
 namespace genome {
 namespace filesystem {
 
 namespace /*{anonymous}*/ {
 
+	// numbers the temporary files of this process
+#if !!GENOME_CXX11
+	std::atomic<unsigned long> s_temp_count(0);
+#else
+	unsigned long s_temp_count = 0;
+#endif
+
 	struct path_compare {
 		struct compare {
 			bool operator()(char const& a, char const& b) const
@@ -393,5 +448,231 @@ get_last_write_time(char const* filename, struct std::tm& utc)
 	return (false);
 }
 
+bool
+get_file_size(char const* filename, u64& size)
+{
+	struct stat s;
+	if ((0 == stat(system_complete(filename).c_str(), &s)) && (s.st_size >= 0)) {
+		size = static_cast<u64>(s.st_size);
+		return (true);
+	}
+	return (false);
+}
+
+bool
+list_files(char const* path, char const* type, std::vector<std::string>& names)
+{
+	names.clear();
+	std::string const dir(system_complete(path));
+	std::string const ext(type ? type : "");
+	std::vector<std::string> found;
+#if !!GENOME_HAVE_FINDFIRSTFILE
+	WIN32_FIND_DATAA fd;
+	HANDLE const find = FindFirstFileA((dir + GENOME_TARGET_PATH_DELIMITER + "*" + ext).c_str(), &fd);
+	if (INVALID_HANDLE_VALUE == find) {
+		return (ERROR_FILE_NOT_FOUND == GetLastError());
+	}
+	do {
+		if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+			found.push_back(fd.cFileName);
+		}
+	} while (FindNextFileA(find, &fd));
+	FindClose(find);
+#else
+	DIR* const find = opendir(dir.empty() ? "." : dir.c_str());
+	if (!find) {
+		return (false);
+	}
+	while (struct dirent const* ent = readdir(find)) {
+		found.push_back(ent->d_name);
+	}
+	closedir(find);
+#endif
+	for (std::vector<std::string>::const_iterator name = found.begin(); name != found.end(); ++name) {
+		// FindFirstFile also matches the short (8.3) names
+		if ((name->size() > ext.size()) && (0 == name->compare(name->size() - ext.size(), ext.size(), ext))) {
+			names.push_back(*name);
+		}
+	}
+	return (true);
+}
+
+bool
+read_file(char const* filename, std::vector<u8>& data)
+{
+	data.clear();
+	u64 size;
+	if (!get_file_size(filename, size) || (static_cast<std::size_t>(size) != size)) {
+		return (false);
+	}
+	std::ifstream file(system_complete(filename).c_str(), std::ios_base::in | std::ios_base::binary);
+	if (!file) {
+		return (false);
+	}
+	data.resize(static_cast<std::size_t>(size));
+	if (size && !file.read(reinterpret_cast<char*>(&data[0]), static_cast<std::streamsize>(size))) {
+		data.clear();
+		return (false);
+	}
+	return (true);
+}
+
+bool
+update_file(char const* filename, char const* data, std::size_t size, bool& written)
+{
+	written = false;
+	std::string const path(system_complete(filename));
+	// compare the size first, then the content (in chunks)
+	u64 old_size;
+	if (get_file_size(filename, old_size) && (old_size == size)) {
+		std::ifstream old_file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+		std::vector<char> buf(std::min<std::size_t>(std::max<std::size_t>(size, 1), 64 * 1024));
+		bool same = !!old_file;
+		for (std::size_t pos = 0; same && (pos < size);) {
+			std::size_t const count = std::min(buf.size(), size - pos);
+			old_file.read(&buf[0], static_cast<std::streamsize>(count));
+			same = (static_cast<std::size_t>(old_file.gcount()) == count) && (0 == std::memcmp(&buf[0], data + pos, count));
+			pos += count;
+		}
+		if (same) {
+			return (true);
+		}
+	}
+	// replace the file with a completely written temporary file
+	std::string const temp(temp_file_name(filename));
+	{
+		std::ofstream new_file(temp.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (size) {
+			new_file.write(data, static_cast<std::streamsize>(size));
+		}
+		new_file.close();
+		if (new_file.fail()) {
+			std::remove(temp.c_str());
+			return (false);
+		}
+	}
+	return (replace_file(filename, temp.c_str(), false, written));
+}
+
+std::string
+file_identity(char const* filename)
+{
+	std::string p(system_complete(filename));
+	// an existing file is identified by device and inode (covers links)
+	struct stat s;
+	if ((0 == stat(p.c_str(), &s)) && (s.st_ino != 0)) {
+		std::string id(1, '\0');
+		id.append(reinterpret_cast<char const*>(&s.st_dev), sizeof(s.st_dev));
+		id.append(reinterpret_cast<char const*>(&s.st_ino), sizeof(s.st_ino));
+		return (id);
+	}
+	// otherwise by the absolute path without "." and ".." (and case on Windows)
+	char const delimiters[] = { '/', GENOME_TARGET_PATH_DELIMITER, '\0' };
+	std::string root;
+	std::string::size_type pos = 0;
+#ifdef _WIN32
+	std::transform(p.begin(), p.end(), p.begin(), ::tolower);
+	if ((p.size() > 1) && (':' == p[1])) {
+		root = p.substr(0, 2);
+		pos = 2;
+	}
+#endif
+	if ((pos >= p.size()) || !std::strchr(delimiters, p[pos])) {
+		char cwd[4096];
+		if (getcwd(cwd, sizeof(cwd))) {
+			std::string c(cwd);
+#ifdef _WIN32
+			std::transform(c.begin(), c.end(), c.begin(), ::tolower);
+			if ((c.size() > 1) && (':' == c[1])) {
+				root = c.substr(0, 2);
+				c.erase(0, 2);
+			}
+#endif
+			p = root + c + GENOME_TARGET_PATH_DELIMITER + p.substr(pos);
+			pos = root.size();
+		}
+	}
+	std::vector<std::string> parts;
+	while (pos <= p.size()) {
+		std::string::size_type const end = p.find_first_of(delimiters, pos);
+		std::string const part(p, pos, (std::string::npos == end) ? std::string::npos : end - pos);
+		if (".." == part) {
+			if (!parts.empty()) {
+				parts.pop_back();
+			}
+		} else if (!part.empty() && ("." != part)) {
+			parts.push_back(part);
+		}
+		if (std::string::npos == end) {
+			break;
+		}
+		pos = end + 1;
+	}
+	std::string id(root);
+	for (std::vector<std::string>::const_iterator i = parts.begin(); i != parts.end(); ++i) {
+		id += GENOME_TARGET_PATH_DELIMITER;
+		id += *i;
+	}
+	return (id);
+}
+
+std::string
+temp_file_name(char const* filename)
+{
+	// unique per process and call (two writers of one file, or two processes
+	// storing the same file, must not share and truncate one temporary file)
+	std::string const path(system_complete(filename));
+	std::string const pid(to_string(static_cast<unsigned long>(getpid())));
+	for (;;) {
+		std::string const temp(path + "." + pid + "-" + to_string(static_cast<unsigned long>(++s_temp_count)) + ".tmp");
+		u64 size;
+		if (!get_file_size(temp.c_str(), size)) {
+			return (temp);
+		}
+	}
+}
+
+bool
+replace_file(char const* filename, char const* temp, bool keep_same, bool& written)
+{
+	written = false;
+	std::string const path(system_complete(filename));
+	if (keep_same) {
+		// compare the size first, then the content (in chunks)
+		u64 old_size;
+		u64 new_size;
+		if (get_file_size(filename, old_size) && get_file_size(temp, new_size) && (old_size == new_size)) {
+			std::ifstream old_file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+			std::ifstream new_file(temp, std::ios_base::in | std::ios_base::binary);
+			std::vector<char> old_buf(64 * 1024);
+			std::vector<char> new_buf(old_buf.size());
+			bool same = old_file && new_file;
+			for (u64 pos = 0; same && (pos < new_size);) {
+				std::size_t const count = static_cast<std::size_t>(std::min<u64>(old_buf.size(), new_size - pos));
+				old_file.read(&old_buf[0], static_cast<std::streamsize>(count));
+				new_file.read(&new_buf[0], static_cast<std::streamsize>(count));
+				same = (static_cast<std::size_t>(old_file.gcount()) == count) &&
+					(static_cast<std::size_t>(new_file.gcount()) == count) &&
+					(0 == std::memcmp(&old_buf[0], &new_buf[0], count));
+				pos += count;
+			}
+			if (same) {
+				new_file.close();
+				return (0 == std::remove(temp));
+			}
+		}
+	}
+#if !!GENOME_HAVE_MOVEFILEEX
+	if (!MoveFileExA(temp, path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+	if (0 != std::rename(temp, path.c_str())) {
+#endif
+		std::remove(temp);
+		return (false);
+	}
+	written = true;
+	return (true);
+}
+
 } // namespace genome::filesystem
 } // namespace genome
@@ -25,6 +25,7 @@
 #include <genome/genome.hpp>
 #include <ctime>
 #include <string>
+#include <vector>
 
 //
 // VERY simple wrappers around canonical Genome filenames.
@@ -56,6 +57,25 @@ bool create_directories(char const* path);
 bool ensure_directories(char const* filename);
 // get last modification timestamp (in UTC) of a native/canonical file
 bool get_last_write_time(char const* filename, struct std::tm& utc);
+// get size (in octets) of a native/canonical file
+bool get_file_size(char const* filename, u64& size);
+// names of the files with the type (".ext") in a native/canonical directory
+bool list_files(char const* path, char const* type, std::vector<std::string>& names);
+// read the complete content of a native/canonical file
+bool read_file(char const* filename, std::vector<u8>& data);
+// write a native/canonical file through a temporary file and rename,
+// unless it already has this content (written = false if unchanged)
+bool update_file(char const* filename, char const* data, std::size_t size, bool& written);
+// key that is equal for all native/canonical names of one file (device and
+// inode if it exists, otherwise the normalized absolute path)
+std::string file_identity(char const* filename);
+// unique native temporary file name next to a native/canonical file
+// ("<file>.<pid>-<n>.tmp", see replace_file)
+std::string temp_file_name(char const* filename);
+// replace a native/canonical file with a completely written native temporary
+// file (removed on failure), or only remove the temporary file if keep_same is
+// set and the file already has the same content (written = false)
+bool replace_file(char const* filename, char const* temp, bool keep_same, bool& written);
 
 } // namespace genome::filesystem
 } // namespace genome
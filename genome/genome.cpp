@@ -22,12 +22,16 @@
 #include <genome/genome.hpp>
 #include <genome/locale.hpp>
 #include <genome/filesystem.hpp>
+#include <genome/logger.hpp>
+#include <genome/profile.hpp>
 
 void
 init_genome(void)
 {
 	genome::locale::init();
 	genome::filesystem::init();
+	genome::logger::init();
+	genome::profile::init();
 }
 
 namespace genome {
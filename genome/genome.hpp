@@ -203,6 +203,13 @@ enum target_config {
 #undef GENOME_INTEGER_BIG_ENDIAN
 #undef GENOME_INTEGER_LITTLE_ENDIAN
 
+// SSE2 is part of x86-64 (optional on x86, disabled with GENOME_NO_SIMD)
+#if !defined(GENOME_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+# define GENOME_SIMD_SSE2 1
+#else
+# define GENOME_SIMD_SSE2 0
+#endif
+
 //
 // platforms
 //
@@ -20,6 +20,10 @@
 // THE SOFTWARE.
 //
 #include <genome/hash.hpp>
+#include <algorithm>
+#if GENOME_SIMD_SSE2
+# include <emmintrin.h>
+#endif
 
 namespace genome {
 
@@ -34,6 +38,122 @@ namespace /*{anonymous}*/ {
 		return (static_cast<u32>(static_cast<i32>(static_cast<i8>(c))));
 	}
 
+	// sign-extended canonical characters of the identifier hash
+	struct hash_name_table {
+		u32 chars[256];
+		hash_name_table(void)
+		{
+			for (unsigned int c = 0; c < 256; ++c) {
+				chars[c] = hash_char_cast(name_traits::canonicalize(static_cast<byte_char>(c)));
+			}
+		}
+	};
+	hash_name_table const hash_name_chars;
+
+	struct hash_batch_item {
+		byte_char const* str;
+		std::size_t      len;
+		std::size_t      idx;  // result index
+	};
+
+	struct hash_batch_item_less {
+		bool operator()(hash_batch_item const& lhs, hash_batch_item const& rhs) const
+		{
+			return (lhs.len < rhs.len);
+		}
+	};
+
+	enum {
+		hash_batch_lanes = 4
+	};
+
+	inline
+	u32
+	hash_name_chars_update(byte_char const* str, std::size_t len, u32 h)
+	{
+		u32 const* const tab = hash_name_chars.chars;
+		for (std::size_t i = 0; i < len; ++i) {
+			h += (h << 5) + tab[str[i]];
+		}
+		return (h);
+	}
+
+	// Hashes the items in groups of similar length: the common prefix
+	// of each group is processed in parallel lanes, the rest is scalar.
+	void
+	hash_name_items(std::vector<hash_batch_item>& items, string_hash hashes[])
+	{
+		std::sort(items.begin(), items.end(), hash_batch_item_less());
+		u32 const* const tab = hash_name_chars.chars;
+		std::size_t i = 0;
+		for (; i + hash_batch_lanes <= items.size(); i += hash_batch_lanes) {
+			hash_batch_item const* const item = &items[i];
+			std::size_t const common = item[0].len;  // shortest in group
+			u32 lane[hash_batch_lanes];
+#if GENOME_SIMD_SSE2
+			__m128i h = _mm_set1_epi32(static_cast<int>(hash_name_init()));
+			for (std::size_t p = 0; p < common; ++p) {
+				__m128i const c = _mm_set_epi32(
+					static_cast<int>(tab[item[3].str[p]]),
+					static_cast<int>(tab[item[2].str[p]]),
+					static_cast<int>(tab[item[1].str[p]]),
+					static_cast<int>(tab[item[0].str[p]]));
+				h = _mm_add_epi32(_mm_add_epi32(h, _mm_slli_epi32(h, 5)), c);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lane), h);
+#else
+			for (std::size_t l = 0; l < hash_batch_lanes; ++l) {
+				lane[l] = u32(hash_name_init());
+			}
+			for (std::size_t p = 0; p < common; ++p) {
+				for (std::size_t l = 0; l < hash_batch_lanes; ++l) {
+					lane[l] += (lane[l] << 5) + tab[item[l].str[p]];
+				}
+			}
+#endif
+			for (std::size_t l = 0; l < hash_batch_lanes; ++l) {
+				hashes[item[l].idx] = string_hash(hash_name_chars_update(
+					item[l].str + common, item[l].len - common, lane[l]));
+			}
+		}
+		for (; i < items.size(); ++i) {
+			hashes[items[i].idx] = string_hash(hash_name_chars_update(
+				items[i].str, items[i].len, u32(hash_name_init())));
+		}
+	}
+
+	inline
+	std::size_t
+	hash_string_length(byte_char const* str)
+	{
+		std::size_t len = 0;
+		if (str) {
+			while (str[len]) {
+				++len;
+			}
+		}
+		return (len);
+	}
+
+	inline
+	std::size_t
+	hash_string_length(byte_string const& str)
+	{
+		// the byte_string overloads hash up to the first NUL (c_str)
+		return (static_cast<std::size_t>(std::find(str.begin(), str.end(), byte_char(0)) - str.begin()));
+	}
+
+	inline
+	hash_batch_item
+	make_hash_batch_item(byte_char const* str, std::size_t len, std::size_t idx)
+	{
+		hash_batch_item item;
+		item.str = str;
+		item.len = len;
+		item.idx = idx;
+		return (item);
+	}
+
 } // namespace genome::{anonymous}
 
 //
@@ -102,6 +222,74 @@ hash_filename(byte_string const& filename)
 	return (hash_filename(filename.c_str()));
 }
 
+//
+// batched hashes
+//
+
+void
+hash_name_batch(byte_char const* const names[], std::size_t count, string_hash hashes[])
+{
+	std::vector<hash_batch_item> items;
+	items.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		items.push_back(make_hash_batch_item(names[i], hash_string_length(names[i]), i));
+	}
+	hash_name_items(items, hashes);
+}
+
+void
+hash_name_batch(std::vector<byte_string> const& names, std::vector<string_hash>& hashes)
+{
+	hashes.resize(names.size());
+	std::vector<hash_batch_item> items;
+	items.reserve(names.size());
+	for (std::size_t i = 0; i < names.size(); ++i) {
+		items.push_back(make_hash_batch_item(names[i].data(), hash_string_length(names[i]), i));
+	}
+	if (!items.empty()) {
+		hash_name_items(items, &hashes[0]);
+	}
+}
+
+void
+hash_filename_batch(byte_char const* const filenames[], std::size_t count, string_hash hashes[])
+{
+	std::vector<hash_batch_item> items;
+	items.reserve(count);
+	for (std::size_t i = 0; i < count; ++i) {
+		byte_char const* const str = filenames[i];
+		std::size_t const len = hash_string_length(str);
+		if (!str || std::find(str, str + len, byte_code::percent_sign) != str + len) {
+			// tags (and NULL) are rare, use the scalar function
+			hashes[i] = hash_filename(str);
+		} else {
+			items.push_back(make_hash_batch_item(str, len, i));
+		}
+	}
+	hash_name_items(items, hashes);
+}
+
+void
+hash_filename_batch(std::vector<byte_string> const& filenames, std::vector<string_hash>& hashes)
+{
+	hashes.resize(filenames.size());
+	std::vector<hash_batch_item> items;
+	items.reserve(filenames.size());
+	for (std::size_t i = 0; i < filenames.size(); ++i) {
+		byte_string const& str = filenames[i];
+		std::size_t const len = hash_string_length(str);
+		if (str.empty() || std::find(str.begin(), str.begin() + len, byte_code::percent_sign) != str.begin() + len) {
+			// tags (and empty names) are rare, use the scalar function
+			hashes[i] = hash_filename(str);
+		} else {
+			items.push_back(make_hash_batch_item(str.data(), len, i));
+		}
+	}
+	if (!items.empty()) {
+		hash_name_items(items, &hashes[0]);
+	}
+}
+
 //
 // ASCII (Windows-1252) hash string conversion
 //
@@ -24,6 +24,8 @@
 
 #include <genome/genome.hpp>
 #include <genome/string.hpp>
+#include <cstddef>
+#include <vector>
 
 namespace genome {
 
@@ -105,6 +107,21 @@ hash_name(byte_string const& name)
 string_hash hash_filename(byte_char const* filename);
 string_hash hash_filename(byte_string const& filename);
 
+//
+// batched hashes (bit-identical to the single-string functions above)
+//
+// The pointer variants match hash_name/hash_filename(byte_char const*),
+// the vector variants match the byte_string overloads. Strings of similar
+// length are hashed in parallel lanes (SSE2 if available). The sorting and
+// gathering costs more than it saves for the short string table ids, so
+// read_map/read_csv use the single-string functions.
+//
+
+void hash_name_batch(byte_char const* const names[], std::size_t count, string_hash hashes[]);
+void hash_name_batch(std::vector<byte_string> const& names, std::vector<string_hash>& hashes);
+void hash_filename_batch(byte_char const* const filenames[], std::size_t count, string_hash hashes[]);
+void hash_filename_batch(std::vector<byte_string> const& filenames, std::vector<string_hash>& hashes);
+
 //
 // hash string conversion ([0-9a-f]{8})
 //
@@ -0,0 +1,307 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/hash_recovery.hpp>
+#include <genome/parallel.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+namespace genome {
+
+namespace /*{anonymous}*/ {
+
+	// brute-force alphabet (the name hash is case-insensitive)
+	byte_char const brute_force_chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+	enum brute_force_config {
+		brute_force_count = sizeof(brute_force_chars) - 1,
+		max_length_limit = hash_recovery::max_brute_force_length
+	};
+
+} // namespace genome::{anonymous}
+
+//
+// hash_recovery::target_set
+//
+
+hash_recovery::target_set::target_set(void)
+	: m_filter()
+	, m_exact()
+{
+}
+
+void
+hash_recovery::target_set::insert(string_hash hash)
+{
+	if (m_filter.empty()) {
+		m_filter.resize(std::size_t(1) << (filter_bits - 5), 0);
+	}
+	u32 const bit = static_cast<u32>(hash) & u32(filter_mask);
+	m_filter[bit >> 5] |= u32(1) << (bit & 31);
+	m_exact.insert(std::make_pair(hash, u8(0)));
+}
+
+std::size_t
+hash_recovery::target_set::size(void) const
+{
+	return (m_exact.size());
+}
+
+//
+// hash_recovery::dictionary_task
+//
+
+class hash_recovery::dictionary_task : public parallel_task {
+public:
+	// one index per head
+	dictionary_task(hash_recovery const& rec)
+		: m_rec(rec)
+		, m_matches(rec.m_heads.size())
+	{
+	}
+	virtual void run(std::size_t index) GENOME_OVERRIDE
+	{
+		affix const& head = m_rec.m_heads[index];
+		std::vector<affix> const& words = m_rec.m_words;
+		std::vector<affix> const& tails = m_rec.m_tails;
+		for (std::size_t w = 0; w < words.size(); ++w) {
+			u32 const state = head.add * words[w].mul + words[w].add;
+			for (std::size_t t = 0; t < tails.size(); ++t) {
+				u32 const h = state * tails[t].mul + tails[t].add;
+				if (m_rec.m_targets.contains(string_hash(h))) {
+					match& m = *m_matches[index].insert(m_matches[index].end(), match());
+					m.hash = string_hash(h);
+					m.name = head.str + words[w].str + tails[t].str;
+					m.head = index;
+					m.source = match_dictionary;
+				}
+			}
+		}
+	}
+	void collect(match_list& matches) const
+	{
+		for (std::size_t i = 0; i < m_matches.size(); ++i) {
+			matches.insert(matches.end(), m_matches[i].begin(), m_matches[i].end());
+		}
+	}
+private:
+	dictionary_task(dictionary_task const&) GENOME_DELETE_FUNCTION;
+	dictionary_task& operator=(dictionary_task const&) GENOME_DELETE_FUNCTION;
+	hash_recovery const&    m_rec;
+	std::vector<match_list> m_matches;  // per index (no locking)
+};
+
+//
+// hash_recovery::brute_force_task
+//
+
+class hash_recovery::brute_force_task : public parallel_task {
+public:
+	// one index per head and first character
+	brute_force_task(hash_recovery const& rec, std::size_t max_length, std::size_t heads, std::size_t tails)
+		: m_rec(rec)
+		, m_max_length(max_length)
+		, m_heads(heads)
+		, m_tails(tails)
+		, m_matches(heads * brute_force_count)
+	{
+		for (std::size_t c = 0; c < brute_force_count; ++c) {
+			byte_char const s[2] = { brute_force_chars[c], 0 };
+			m_codes[c] = static_cast<u32>(hash_name_update(s, string_hash(u32(0))));
+		}
+	}
+	virtual void run(std::size_t index) GENOME_OVERRIDE
+	{
+		std::size_t const h = index / brute_force_count;
+		std::size_t const c = index % brute_force_count;
+		byte_char buf[max_length_limit];
+		buf[0] = brute_force_chars[c];
+		extend(index, h, m_rec.m_heads[h].add * 33 + m_codes[c], buf, 1);
+	}
+	void collect(match_list& matches) const
+	{
+		for (std::size_t i = 0; i < m_matches.size(); ++i) {
+			matches.insert(matches.end(), m_matches[i].begin(), m_matches[i].end());
+		}
+	}
+private:
+	brute_force_task(brute_force_task const&) GENOME_DELETE_FUNCTION;
+	brute_force_task& operator=(brute_force_task const&) GENOME_DELETE_FUNCTION;
+	void extend(std::size_t index, std::size_t head, u32 state, byte_char buf[], std::size_t len)
+	{
+		std::vector<affix> const& tails = m_rec.m_tails;
+		for (std::size_t t = 0; t < m_tails; ++t) {
+			u32 const h = state * tails[t].mul + tails[t].add;
+			if (m_rec.m_targets.contains(string_hash(h))) {
+				match& m = *m_matches[index].insert(m_matches[index].end(), match());
+				m.hash = string_hash(h);
+				m.name = m_rec.m_heads[head].str;
+				m.name.append(buf, buf + len);
+				m.name.append(tails[t].str);
+				m.head = head;
+				m.source = match_brute_force;
+			}
+		}
+		if (len < m_max_length) {
+			for (std::size_t c = 0; c < brute_force_count; ++c) {
+				buf[len] = brute_force_chars[c];
+				extend(index, head, state * 33 + m_codes[c], buf, len + 1);
+			}
+		}
+	}
+	hash_recovery const&    m_rec;
+	std::size_t const       m_max_length;
+	std::size_t const       m_heads;
+	std::size_t const       m_tails;
+	std::vector<match_list> m_matches;  // per index (no locking)
+	u32                     m_codes[brute_force_count];
+};
+
+//
+// hash_recovery
+//
+
+hash_recovery::hash_recovery(void)
+	: m_targets()
+	, m_heads()
+	, m_tails()
+	, m_words()
+	, m_head_set()
+	, m_tail_set()
+	, m_word_set()
+{
+	add_affix(m_heads, m_head_set, byte_string());
+	add_affix(m_tails, m_tail_set, byte_string());
+	m_heads.front().add = static_cast<u32>(hash_name_init());
+}
+
+void
+hash_recovery::add_target(string_hash hash)
+{
+	m_targets.insert(hash);
+}
+
+bool
+hash_recovery::add_head(byte_string const& head)
+{
+	if (!add_affix(m_heads, m_head_set, head)) {
+		return (false);
+	}
+	// heads are stored as the complete djb2 state
+	m_heads.back().add = static_cast<u32>(hash_name_update(head.c_str(), hash_name_init()));
+	return (true);
+}
+
+bool
+hash_recovery::add_tail(byte_string const& tail)
+{
+	return (add_affix(m_tails, m_tail_set, tail));
+}
+
+bool
+hash_recovery::add_word(byte_string const& word)
+{
+	return (!word.empty() && add_affix(m_words, m_word_set, word));
+}
+
+std::size_t
+hash_recovery::target_count(void) const
+{
+	return (m_targets.size());
+}
+
+std::size_t
+hash_recovery::head_count(void) const
+{
+	return (m_heads.size());
+}
+
+std::size_t
+hash_recovery::tail_count(void) const
+{
+	return (m_tails.size());
+}
+
+std::size_t
+hash_recovery::word_count(void) const
+{
+	return (m_words.size());
+}
+
+u64
+hash_recovery::run_dictionary(match_list& matches, std::size_t threads) const
+{
+	if ((0 == m_targets.size()) || m_words.empty()) {
+		return (0);
+	}
+	dictionary_task task(*this);
+	parallel_for(task, m_heads.size(), threads);
+	task.collect(matches);
+	return (u64(m_heads.size()) * u64(m_words.size()) * u64(m_tails.size()));
+}
+
+u64
+hash_recovery::run_brute_force(match_list& matches, std::size_t max_length, std::size_t max_heads, std::size_t max_tails, std::size_t threads) const
+{
+	if ((0 == m_targets.size()) || (0 == max_length)) {
+		return (0);
+	}
+	if (max_length > std::size_t(max_length_limit)) {
+		throw std::invalid_argument("brute force length exceeds " + to_string(int(max_length_limit)));
+	}
+	std::size_t const heads = std::min(m_heads.size(), max_heads ? max_heads : m_heads.size());
+	std::size_t const tails = std::min(m_tails.size(), max_tails ? max_tails : m_tails.size());
+	brute_force_task task(*this, max_length, heads, tails);
+	parallel_for(task, heads * brute_force_count, threads);
+	task.collect(matches);
+	u64 mids = 0;
+	for (u64 i = 0, n = 1; i < max_length; ++i) {
+		n *= brute_force_count;
+		mids += n;
+	}
+	return (u64(heads) * mids * u64(tails));
+}
+
+bool
+hash_recovery::add_affix(std::vector<affix>& list, affix_set& seen, byte_string const& str)
+{
+	affix const a(make_affix(str));
+	if (!seen.insert(std::make_pair(a.add, a.len)).second) {
+		return (false);
+	}
+	list.push_back(a);
+	return (true);
+}
+
+hash_recovery::affix
+hash_recovery::make_affix(byte_string const& str)
+{
+	affix a;
+	a.str = str;
+	a.mul = 1;
+	for (std::size_t i = 0; i < str.size(); ++i) {
+		a.mul *= 33;
+	}
+	a.add = static_cast<u32>(hash_name_update(str.c_str(), string_hash(u32(0))));
+	a.len = static_cast<u32>(str.size());
+	return (a);
+}
+
+} // namespace genome
@@ -0,0 +1,127 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_HASH_RECOVERY_HPP
+#define GENOME_HASH_RECOVERY_HPP
+
+#include <genome/genome.hpp>
+#include <genome/hash.hpp>
+#include <genome/hash_table.hpp>
+#include <genome/string.hpp>
+#include <cstddef>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace genome {
+
+//
+// identifier recovery for unknown hash_name() values
+//
+// Candidates are built as head + middle + tail, where the middle part is
+// a dictionary word or a brute-forced [a-z0-9_] sequence. The djb2 state
+// of every head is computed once and extended incrementally, the tails
+// are applied as affine maps (state * 33^length + tail hash from zero).
+//
+
+class hash_recovery {
+public:
+	enum limits {
+		// heads * 37^length * tails candidates (37^6 is already 2.6e9 per head/tail pair)
+		max_brute_force_length = 6,
+		// heads/tails combined by the brute force of the string table's
+		// recover_ids (the most frequent ones, the dictionary uses all)
+		brute_force_heads = 64,
+		brute_force_tails = 16
+	};
+	enum match_source {
+		match_dictionary,   // head + word + tail
+		match_brute_force   // head + [a-z0-9_]{1,n} + tail
+	};
+	struct match {
+		string_hash  hash;
+		byte_string  name;
+		std::size_t  head;  // index of the used head (0 = none)
+		match_source source;
+	};
+	typedef std::vector<match> match_list;
+	hash_recovery(void);
+	// heads/tails in priority order (the empty head/tail is always index 0)
+	void add_target(string_hash hash);
+	bool add_head(byte_string const& head);
+	bool add_tail(byte_string const& tail);
+	bool add_word(byte_string const& word);
+	std::size_t target_count(void) const;
+	std::size_t head_count(void) const;
+	std::size_t tail_count(void) const;
+	std::size_t word_count(void) const;
+	// appends all matches and returns the number of tested candidates
+	// (run_brute_force throws std::invalid_argument above max_brute_force_length)
+	u64 run_dictionary(match_list& matches, std::size_t threads = 0) const;
+	u64 run_brute_force(match_list& matches, std::size_t max_length, std::size_t max_heads, std::size_t max_tails, std::size_t threads = 0) const;
+private:
+	struct affix {
+		byte_string str;
+		u32         mul;  // 33^length
+		u32         add;  // hash from zero
+		u32         len;
+	};
+	class target_set {
+	public:
+		target_set(void);
+		void insert(string_hash hash);
+		std::size_t size(void) const;
+		bool contains(string_hash hash) const
+		{
+			// bitmap prefilter, the exact table is rarely consulted
+			u32 const bit = static_cast<u32>(hash) & u32(filter_mask);
+			if (!(m_filter[bit >> 5] & (u32(1) << (bit & 31)))) {
+				return (false);
+			}
+			return (m_exact.find(hash) != m_exact.end());
+		}
+	private:
+		enum config {
+			filter_bits = 24,
+			filter_mask = (1 << filter_bits) - 1
+		};
+		std::vector<u32> m_filter;
+		hash_table<u8>   m_exact;
+	};
+	class dictionary_task;
+	class brute_force_task;
+	friend class dictionary_task;
+	friend class brute_force_task;
+	typedef std::set<std::pair<u32, u32> > affix_set;  // (add, len) of equivalent affixes
+	static bool add_affix(std::vector<affix>& list, affix_set& seen, byte_string const& str);
+	static affix make_affix(byte_string const& str);
+	target_set          m_targets;
+	std::vector<affix>  m_heads;
+	std::vector<affix>  m_tails;
+	std::vector<affix>  m_words;
+	affix_set           m_head_set;
+	affix_set           m_tail_set;
+	affix_set           m_word_set;
+};
+
+} // namespace genome
+
+#endif // GENOME_HASH_RECOVERY_HPP
@@ -0,0 +1,65 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/hash_table.hpp>
+#include <algorithm>
+
+namespace genome {
+
+//
+// sort_hashes
+//
+
+void
+sort_hashes(std::vector<string_hash>& hashes, bool descending)
+{
+	std::vector<string_hash>::size_type const count = hashes.size();
+	if (count < 2) {
+		return;
+	}
+	// descending order is ascending order of the inverted keys
+	u32 const flip = descending ? u32(-1) : u32(0);
+	std::vector<string_hash> temp(count);
+	std::vector<string_hash>* src = &hashes;
+	std::vector<string_hash>* dst = &temp;
+	for (unsigned shift = 0; shift < 32; shift += 8) {
+		std::vector<string_hash>::size_type offs[256 + 1] = {0};
+		for (std::vector<string_hash>::size_type i = 0; i < count; ++i) {
+			++offs[((((*src)[i] ^ flip) >> shift) & 0xFFU) + 1];
+		}
+		if (count == offs[((((*src)[0] ^ flip) >> shift) & 0xFFU) + 1]) {
+			continue;  // all keys share this digit
+		}
+		for (unsigned d = 0; d < 256; ++d) {
+			offs[d + 1] += offs[d];
+		}
+		for (std::vector<string_hash>::size_type i = 0; i < count; ++i) {
+			string_hash const h = (*src)[i];
+			(*dst)[offs[((h ^ flip) >> shift) & 0xFFU]++] = h;
+		}
+		std::swap(src, dst);
+	}
+	if (src != &hashes) {
+		hashes.swap(temp);
+	}
+}
+
+} // namespace genome
@@ -0,0 +1,84 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_HASH_TABLE_HPP
+#define GENOME_HASH_TABLE_HPP
+
+#include <genome/genome.hpp>
+#include <genome/hash.hpp>
+#include <utility>
+#include <vector>
+
+namespace genome {
+
+//
+// sort string hashes (LSD radix sort, 4 passes of 8 bits)
+//
+
+void sort_hashes(std::vector<string_hash>& hashes, bool descending = false);
+
+//
+// flat open-addressing hash table with string_hash keys
+//
+// The entries are stored densely in insertion order (iterators are
+// invalidated by insert), the slot index uses linear probing with
+// entry index + 1 (0 = empty slot). There is no key order; use
+// sorted_keys() if the keys are required in hash order.
+//
+
+template<typename T>
+class hash_table {
+public:
+	typedef string_hash key_type;
+	typedef T mapped_type;
+	typedef std::pair<string_hash, T> value_type;
+	typedef std::vector<value_type> entry_list;
+	typedef typename entry_list::size_type size_type;
+	typedef typename entry_list::iterator iterator;
+	typedef typename entry_list::const_iterator const_iterator;
+	hash_table(void);
+	bool empty(void) const;
+	size_type size(void) const;
+	void clear(void);
+	void reserve(size_type count);
+	std::size_t heap_bytes(void) const;  // allocated capacity of entries and slots
+	iterator begin(void);
+	iterator end(void);
+	const_iterator begin(void) const;
+	const_iterator end(void) const;
+	iterator find(key_type const& key);
+	const_iterator find(key_type const& key) const;
+	std::pair<iterator, bool> insert(value_type const& value);
+	void sorted_keys(std::vector<key_type>& keys, bool descending = false) const;
+	void swap(hash_table& other);
+private:
+	static size_type hash_slot(key_type const& key, size_type mask);
+	size_type find_slot(key_type const& key) const;
+	void rehash(size_type slot_count);
+	entry_list       m_entries;
+	std::vector<u32> m_slots;
+};
+
+} // namespace genome
+
+#include <genome/hash_table.ipp>
+
+#endif // GENOME_HASH_TABLE_HPP
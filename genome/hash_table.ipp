@@ -0,0 +1,210 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_HASH_TABLE_IPP
+#define GENOME_HASH_TABLE_IPP
+
+namespace genome {
+
+//
+// hash_table
+//
+
+template<typename T>
+hash_table<T>::hash_table(void)
+	: m_entries()
+	, m_slots()
+{
+}
+
+template<typename T>
+bool
+hash_table<T>::empty(void) const
+{
+	return (m_entries.empty());
+}
+
+template<typename T>
+typename hash_table<T>::size_type
+hash_table<T>::size(void) const
+{
+	return (m_entries.size());
+}
+
+template<typename T>
+void
+hash_table<T>::clear(void)
+{
+	m_entries.clear();
+	m_slots.clear();
+}
+
+template<typename T>
+void
+hash_table<T>::reserve(size_type count)
+{
+	m_entries.reserve(count);
+	// keep the load factor below 50%
+	size_type slot_count = 16;
+	while (slot_count < count * 2) {
+		slot_count *= 2;
+	}
+	if (slot_count > m_slots.size()) {
+		rehash(slot_count);
+	}
+}
+
+template<typename T>
+std::size_t
+hash_table<T>::heap_bytes(void) const
+{
+	return (m_entries.capacity() * sizeof(value_type) + m_slots.capacity() * sizeof(u32));
+}
+
+template<typename T>
+typename hash_table<T>::iterator
+hash_table<T>::begin(void)
+{
+	return (m_entries.begin());
+}
+
+template<typename T>
+typename hash_table<T>::iterator
+hash_table<T>::end(void)
+{
+	return (m_entries.end());
+}
+
+template<typename T>
+typename hash_table<T>::const_iterator
+hash_table<T>::begin(void) const
+{
+	return (m_entries.begin());
+}
+
+template<typename T>
+typename hash_table<T>::const_iterator
+hash_table<T>::end(void) const
+{
+	return (m_entries.end());
+}
+
+template<typename T>
+typename hash_table<T>::iterator
+hash_table<T>::find(key_type const& key)
+{
+	size_type const slot = find_slot(key);
+	if (m_slots.empty() || !m_slots[slot]) {
+		return (m_entries.end());
+	}
+	return (m_entries.begin() + (m_slots[slot] - 1));
+}
+
+template<typename T>
+typename hash_table<T>::const_iterator
+hash_table<T>::find(key_type const& key) const
+{
+	size_type const slot = find_slot(key);
+	if (m_slots.empty() || !m_slots[slot]) {
+		return (m_entries.end());
+	}
+	return (m_entries.begin() + (m_slots[slot] - 1));
+}
+
+template<typename T>
+std::pair<typename hash_table<T>::iterator, bool>
+hash_table<T>::insert(value_type const& value)
+{
+	if (m_slots.size() < (m_entries.size() + 1) * 2) {
+		rehash(m_slots.empty() ? size_type(16) : m_slots.size() * 2);
+	}
+	size_type const slot = find_slot(value.first);
+	if (m_slots[slot]) {
+		return (std::make_pair(m_entries.begin() + (m_slots[slot] - 1), false));
+	}
+	m_entries.push_back(value);
+	m_slots[slot] = static_cast<u32>(m_entries.size());
+	return (std::make_pair(m_entries.end() - 1, true));
+}
+
+template<typename T>
+void
+hash_table<T>::sorted_keys(std::vector<key_type>& keys, bool descending) const
+{
+	keys.clear();
+	keys.reserve(m_entries.size());
+	for (const_iterator entry = m_entries.begin(); entry != m_entries.end(); ++entry) {
+		keys.push_back(entry->first);
+	}
+	sort_hashes(keys, descending);
+}
+
+template<typename T>
+void
+hash_table<T>::swap(hash_table& other)
+{
+	m_entries.swap(other.m_entries);
+	m_slots.swap(other.m_slots);
+}
+
+template<typename T>
+typename hash_table<T>::size_type
+hash_table<T>::hash_slot(key_type const& key, size_type mask)
+{
+	// the keys are djb2 hashes with weak low bits, use the
+	// high bits of a Fibonacci multiplication as slot index
+	u32 const mix = static_cast<u32>(key * u32(0x9E3779B9UL));
+	return (static_cast<size_type>((mix >> 16) | (mix << 16)) & mask);
+}
+
+template<typename T>
+typename hash_table<T>::size_type
+hash_table<T>::find_slot(key_type const& key) const
+{
+	if (m_slots.empty()) {
+		return (0);
+	}
+	size_type const mask = m_slots.size() - 1;
+	size_type slot = hash_slot(key, mask);
+	while (m_slots[slot] && (m_entries[m_slots[slot] - 1].first != key)) {
+		slot = (slot + 1) & mask;
+	}
+	return (slot);
+}
+
+template<typename T>
+void
+hash_table<T>::rehash(size_type slot_count)
+{
+	m_slots.assign(slot_count, u32(0));
+	size_type const mask = slot_count - 1;
+	for (size_type i = 0; i < m_entries.size(); ++i) {
+		size_type slot = hash_slot(m_entries[i].first, mask);
+		while (m_slots[slot]) {
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = static_cast<u32>(i + 1);
+	}
+}
+
+} // namespace genome
+
+#endif // GENOME_HASH_TABLE_IPP
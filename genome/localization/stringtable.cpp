@@ -20,12 +20,19 @@
 // THE SOFTWARE.
 //
 #include <genome/localization/stringtable.hpp>
+#include <genome/archive_span.hpp>
 #include <genome/filesystem.hpp>
+#include <genome/hash_recovery.hpp>
+#include <genome/logger.hpp>
+#include <genome/parallel.hpp>
+#include <genome/profile.hpp>
 #include <genome/time.hpp>
 #include <genome/tstream.hpp>
 #include <nicode/suffix_tree.hpp>
+#include <cstdio>
 #include <cstdlib>
 #include <algorithm>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
@@ -33,17 +40,104 @@
 #include <list>
 #include <memory>
 #include <new>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <utility>
 
 namespace genome {
 namespace localization {
 
+namespace /*{anonymous}*/ {
+
+// Heap statistics of the suffix_tree allocations (see print_memory).
+// Only counted with GENOME_PROFILE_ALLOCATIONS or the debug allocator.
+//NOTE: not thread-safe (the suffix trees are only built by pack_col).
+
+struct stb_statistics {
+	u64 allocs;
+	u64 live_bytes;
+	u64 peak_bytes;
+	void allocated(std::size_t n)
+	{
+		++allocs;
+		live_bytes += n;
+		peak_bytes = std::max(peak_bytes, live_bytes);
+	}
+	void deallocated(std::size_t n)
+	{
+		live_bytes -= n;
+	}
+} stb_stats = { 0, 0, 0 };
+
+} // namespace genome::localization::{anonymous}
+
 #ifndef GENOME_DEBUG_STB_ALLOCATOR
+#if !GENOME_PROFILE_ALLOCATIONS
 #define stb_allocator std::allocator
 #else
 namespace /*{anonymous}*/ {
 
+// std::allocator that updates the stb_stats
+
+template<typename T>
+class stb_allocator : public std::allocator<T> {
+public:
+	typedef std::size_t size_type;
+	template<typename U>
+	struct rebind {
+		typedef stb_allocator<U> other;
+	};
+	stb_allocator(void) GENOME_NOEXCEPT_NOTHROW
+	{
+	}
+	stb_allocator(stb_allocator<T> const&) GENOME_NOEXCEPT_NOTHROW
+		: std::allocator<T>()
+	{
+	}
+	template<typename U>
+	stb_allocator(stb_allocator<U> const&) GENOME_NOEXCEPT_NOTHROW
+		: std::allocator<T>()
+	{
+	}
+	T* allocate(size_type n, void const* = 0)
+	{
+		T* const p = std::allocator<T>::allocate(n);
+		stb_stats.allocated(n * sizeof(T));
+		return (p);
+	}
+	void deallocate(T* p, size_type n)
+	{
+		stb_stats.deallocated(n * sizeof(T));
+		std::allocator<T>::deallocate(p, n);
+	}
+};
+template<>
+class stb_allocator<void> : public std::allocator<void> {
+public:
+	template<typename U>
+	struct rebind {
+		typedef stb_allocator<U> other;
+	};
+	stb_allocator(void) GENOME_NOEXCEPT_NOTHROW
+	{
+	}
+	stb_allocator(stb_allocator<void> const&) GENOME_NOEXCEPT_NOTHROW
+		: std::allocator<void>()
+	{
+	}
+	template<typename U>
+	stb_allocator(stb_allocator<U> const&) GENOME_NOEXCEPT_NOTHROW
+		: std::allocator<void>()
+	{
+	}
+};
+
+} // namespace genome::localization::{anonymous}
+#endif//GENOME_PROFILE_ALLOCATIONS
+#else
+namespace /*{anonymous}*/ {
+
 // This custom allocator is essential for the suffix_tree performance
 // when running under the MSVC debugger. The memory is only freed when
 // all allocations are deallocated. With the std::allocator it takes
@@ -180,6 +274,7 @@ public:
 			n *= sizeof(value_type);
 			pointer const p = static_cast<pointer>(stb_memory.allocate(n));
 			if (p) {
+				stb_stats.allocated(n);
 				return (p);
 			}
 		}
@@ -187,6 +282,7 @@ public:
 	}
 	void deallocate(pointer p, size_type n)
 	{
+		stb_stats.deallocated(n * sizeof(value_type));
 		stb_memory.deallocate(p, n);
 	}
 	pointer address(reference r) const GENOME_NOEXCEPT_NOTHROW
@@ -314,6 +410,469 @@ namespace /*{anonymous}*/ {
 		return (false);
 	}
 
+	// idname mapping file line (see stringtable::read_map)
+	struct map_line {
+		u32                    lno;
+		bool                   valid;   // no invalid characters
+		byte_string            name;    // [prefix:]id
+		byte_string::size_type id_pos;  // after the first colon
+	};
+
+	// identifier part mined from the known names (see stringtable::recover_ids)
+	struct recovery_affix {
+		byte_string str;
+		u32         count;
+		std::map<u32, u32> prefixes;  // name_arena::handle -> count
+	};
+	struct recovery_affix_order {
+		bool operator()(recovery_affix const& lhs, recovery_affix const& rhs) const
+		{
+			// most frequent first, then shorter, then lexical
+			if (lhs.count != rhs.count) {
+				return (lhs.count > rhs.count);
+			}
+			if (lhs.str.size() != rhs.str.size()) {
+				return (lhs.str.size() < rhs.str.size());
+			}
+			return (lhs.str < rhs.str);
+		}
+	};
+	typedef std::map<byte_string, recovery_affix> recovery_affix_map;
+
+	void
+	add_recovery_affix(recovery_affix_map& map, byte_string const& str, u32 prefix)
+	{
+		recovery_affix& a = map[str];
+		if (a.str.empty()) {
+			a.str = str;
+			a.count = 0;
+		}
+		++a.count;
+		if (prefix) {
+			++a.prefixes[prefix];
+		}
+	}
+
+	std::vector<recovery_affix>
+	sort_recovery_affixes(recovery_affix_map const& map, u32 min_count, std::size_t max_count)
+	{
+		std::vector<recovery_affix> list;
+		for (recovery_affix_map::const_iterator i = map.begin(); i != map.end(); ++i) {
+			if (i->second.count >= min_count) {
+				list.push_back(i->second);
+			}
+		}
+		std::sort(list.begin(), list.end(), recovery_affix_order());
+		if (list.size() > max_count) {
+			list.resize(max_count);
+		}
+		return (list);
+	}
+
+	// number of letter/digit changes ("ACH_48" is more likely than "ACH_2z")
+	std::size_t
+	count_class_changes(byte_string const& name)
+	{
+		std::size_t n = 0;
+		int prev = 0;
+		for (byte_string::const_iterator c = name.begin(); c != name.end(); ++c) {
+			int const cls = ((byte_code::digit_first <= *c) && (*c <= byte_code::digit_last)) ? 1 : (
+				(byte_code::lower_first <= byte_code::to_lower(*c)) && (byte_code::to_lower(*c) <= byte_code::lower_last)) ? 2 : 0;
+			if (cls && prev && (cls != prev)) {
+				++n;
+			}
+			prev = cls;
+		}
+		return (n);
+	}
+
+	struct recovery_match_order {
+		bool operator()(hash_recovery::match const& lhs, hash_recovery::match const& rhs) const
+		{
+			// key_compare order, best name first (dictionary, fewer class changes, shorter, lexical)
+			if (lhs.hash != rhs.hash) {
+				return (lhs.hash > rhs.hash);
+			}
+			if (lhs.source != rhs.source) {
+				return (lhs.source < rhs.source);
+			}
+			std::size_t const lhs_changes = count_class_changes(lhs.name);
+			std::size_t const rhs_changes = count_class_changes(rhs.name);
+			if (lhs_changes != rhs_changes) {
+				return (lhs_changes < rhs_changes);
+			}
+			if (lhs.name.size() != rhs.name.size()) {
+				return (lhs.name.size() < rhs.name.size());
+			}
+			return (lhs.name < rhs.name);
+		}
+	};
+
+	// Buffered UTF-8 CSV output (BOM, LF newlines), the written bytes are
+	// identical to u16otfstream with encoding_utf8 and newline_unix, but
+	// the escaping and encoding is done directly in the output buffer.
+	// With skip_unchanged the file is rendered in memory and only written
+	// (see filesystem::update_file) if the content has been changed.
+	class csv_writer {
+		csv_writer(csv_writer const&) GENOME_DELETE_FUNCTION;
+		csv_writer& operator=(csv_writer const&) GENOME_DELETE_FUNCTION;
+	public:
+		csv_writer(char const* csv_path, bool skip_unchanged)
+			: m_path(csv_path)
+			, m_file()
+			, m_buf(buffer_size)
+			, m_len(0)
+			, m_lead(0)
+			, m_flushed(0)
+			, m_memory(skip_unchanged)
+			, m_written(false)
+		{
+			if (!m_memory) {
+				m_file.open(filesystem::system_complete(csv_path).c_str(), std::ios_base::out | std::ios_base::binary);
+			}
+			m_buf[m_len++] = static_cast<char>(0xEF);
+			m_buf[m_len++] = static_cast<char>(0xBB);
+			m_buf[m_len++] = static_cast<char>(0xBF);
+		}
+		bool operator!(void) const
+		{
+			return (!m_memory && !m_file);
+		}
+		bool written(void) const
+		{
+			return (m_written);
+		}
+		// rendered octets (including the BOM)
+		u64 size(void) const
+		{
+			return (m_flushed + m_len);
+		}
+		// unescaped (CR is ignored, NUL is not accepted)
+		bool put_raw(wide_string const& str)
+		{
+			reserve(str.size() * max_char_bytes);
+			for (wide_string::const_iterator c = str.begin(); c != str.end(); ++c) {
+				if (0x0000 == *c) {
+					return (false);
+				}
+				if ((0x000D != *c) && !put_char(*c)) {
+					return (false);
+				}
+			}
+			return (true);
+		}
+		bool put_separator(void)
+		{
+			reserve(1);
+			return (put_char(0x007C));  // '|'
+		}
+		// escaped field text (see split_csv_line)
+		bool put_text(wide_char const* first, wide_char const* last)
+		{
+			reserve(static_cast<std::size_t>(last - first) * max_char_bytes);
+			char* out = &m_buf[m_len];
+			for (wide_char const* c = first; c != last; ++c) {
+				wide_char const chr = *c;
+				if ((chr < 0x0080) && !m_lead) {
+					switch (chr) {
+					case 0x0000: *out++ = 0x5C; *out++ = 0x30; continue;  // "\0"
+					case 0x000A: *out++ = 0x5C; *out++ = 0x6E; continue;  // "\n"
+					case 0x000D: *out++ = 0x5C; *out++ = 0x72; continue;  // "\r"
+					case 0x0040: *out++ = 0x5C; *out++ = 0x61; continue;  // "\a"
+					case 0x005C: *out++ = 0x5C; *out++ = 0x5C; continue;  // "\\"
+					case 0x007C: *out++ = 0x5C; *out++ = 0x76; continue;  // "\v"
+					default: *out++ = static_cast<char>(chr); continue;
+					}
+				}
+				m_len = static_cast<std::size_t>(out - &m_buf[0]);
+				if (!put_char(chr)) {
+					return (false);
+				}
+				out = &m_buf[m_len];
+			}
+			m_len = static_cast<std::size_t>(out - &m_buf[0]);
+			return (true);
+		}
+		bool put_newline(void)
+		{
+			reserve(1);
+			return (put_char(0x000A));
+		}
+		bool close(void)
+		{
+			if (m_lead) {
+				return (false);
+			}
+			if (m_memory) {
+				return (filesystem::update_file(m_path.c_str(), &m_buf[0], m_len, m_written));
+			}
+			flush();
+			m_file.close();
+			m_written = true;
+			return (!m_file.fail());
+		}
+	private:
+		enum config {
+			buffer_size = 1024 * 1024,
+			max_char_bytes = 3  // UTF-8 per UTF-16 code unit (or escape sequence)
+		};
+		void reserve(std::size_t count)
+		{
+			if (m_len + count > m_buf.size()) {
+				if (m_memory) {
+					m_buf.resize(std::max(m_len + count, m_buf.size() * 2));
+					return;
+				}
+				flush();
+				if (count > m_buf.size()) {
+					m_buf.resize(count);
+				}
+			}
+		}
+		void flush(void)
+		{
+			if (m_len) {
+				m_file.write(&m_buf[0], static_cast<std::streamsize>(m_len));
+				m_flushed += m_len;
+				m_len = 0;
+			}
+		}
+		// the buffer has to be reserved (one code unit, max_char_bytes)
+		bool put_char(wide_char chr)
+		{
+			u32 code = chr;
+			if (m_lead) {
+				// low (trailing) surrogate required
+				if ((code < 0xDC00) || (0xDFFF < code)) {
+					return (false);
+				}
+				code = (((u32(m_lead) - 0xD800) << 10) | (code - 0xDC00)) + 0x00010000UL;
+				m_lead = 0;
+				// the lead octet has been written with the high surrogate
+				m_buf[m_len++] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+				m_buf[m_len++] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+				m_buf[m_len++] = static_cast<char>(0x80 | (code & 0x3F));
+			} else if (code < 0x0080) {
+				m_buf[m_len++] = static_cast<char>(code);
+			} else if (code < 0x0800) {
+				m_buf[m_len++] = static_cast<char>(0xC0 | (code >> 6));
+				m_buf[m_len++] = static_cast<char>(0x80 | (code & 0x3F));
+			} else if ((0xD800 <= code) && (code <= 0xDBFF)) {
+				m_lead = chr;
+				code = ((code - 0xD800) << 10) + 0x00010000UL;
+				m_buf[m_len++] = static_cast<char>(0xF0 | (code >> 18));
+			} else if ((0xDC00 <= code) && (code <= 0xDFFF)) {
+				return (false);
+			} else {
+				m_buf[m_len++] = static_cast<char>(0xE0 | (code >> 12));
+				m_buf[m_len++] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+				m_buf[m_len++] = static_cast<char>(0x80 | (code & 0x3F));
+			}
+			return (true);
+		}
+		std::string       m_path;
+		std::ofstream     m_file;
+		std::vector<char> m_buf;
+		std::size_t       m_len;
+		wide_char         m_lead;     // pending high surrogate
+		u64               m_flushed;  // octets written to m_file
+		bool              m_memory;   // complete file in m_buf
+		bool              m_written;
+	};
+
+	// fourcc_le(u8'C', u8'S', u8'V', version) of the parsed CSV cache
+	u32 const csv_cache_magic = 0x02565343UL;
+
+	// save_state/load_state without a path
+	char const* const default_state_path = "#G3:/lianzifu.state";
+
+	// parse_csv warning, repeated if the parsed table is reused from the cache
+	void
+	warn_csv_ansi(void)
+	{
+		std::wclog << L";warn: CSV with Windows-1252 encoding (UTF-8 without BOM?)" << std::endl;
+	}
+
+	inline
+	archive::streampos
+	align_streampos(std::size_t pos, std::size_t align)
+	{
+		return (static_cast<archive::streampos>(((pos + align - 1) / align) * align));
+	}
+
+	// profile phase detail of a packed column
+	std::string
+	pack_phase_name(byte_string const& col_name, stringtable::compression comp)
+	{
+		static char const* const names[] = { "none", "fast", "lzpb", "lzex", "tree", "best" };
+		std::string name(to_string(col_name));
+		name.push_back('/');
+		name.append((std::size_t(comp) < sizeof(names) / sizeof(names[0])) ? names[comp] : "?");
+		return (name);
+	}
+
+	// list of owned objects (deleted with the list)
+	template<typename T>
+	class owner_list {
+		owner_list(owner_list const&) GENOME_DELETE_FUNCTION;
+		owner_list& operator=(owner_list const&) GENOME_DELETE_FUNCTION;
+	public:
+		owner_list(void)
+			: m_items()
+		{
+		}
+		~owner_list(void)
+		{
+			for (typename std::vector<T*>::iterator item = m_items.begin(); item != m_items.end(); ++item) {
+				delete *item;
+			}
+		}
+		void push_back(T* item)
+		{
+			try {
+				m_items.push_back(item);
+			} catch (...) {
+				delete item;
+				throw;
+			}
+		}
+		std::size_t size(void) const
+		{
+			return (m_items.size());
+		}
+		T& operator[](std::size_t index)
+		{
+			return (*m_items[index]);
+		}
+	private:
+		std::vector<T*> m_items;
+	};
+
+	// fourcc_le(u8'P', u8'K', u8'C', version) of a packed table in the pack cache
+	u32 const pack_cache_magic = 0x01434B50UL;
+	// fourcc_le(u8'P', u8'K', u8'I', version) of the pack cache index
+	u32 const pack_index_magic = 0x01494B50UL;
+
+	// 64-bit FNV-1a (pack cache content hash and checksum)
+	u64 const fnv1a64_init = (u64(0xCBF29CE4UL) << 32) | u64(0x84222325UL);
+	u64 const fnv1a64_prime = (u64(0x00000100UL) << 32) | u64(0x000001B3UL);
+
+	inline
+	u64
+	fnv1a64_update(u64 hash, u32 value, unsigned int octets)
+	{
+		// little-endian octets of the value (independent of the host)
+		for (unsigned int i = 0; i < octets; ++i, value >>= 8) {
+			hash = (hash ^ u64(value & 0xFF)) * fnv1a64_prime;
+		}
+		return (hash);
+	}
+
+	template<typename T>
+	u64
+	fnv1a64_update(u64 hash, std::vector<T> const& values)
+	{
+		for (typename std::vector<T>::const_iterator v = values.begin(); v != values.end(); ++v) {
+			hash = fnv1a64_update(hash, u32(*v), sizeof(T));
+		}
+		return (hash);
+	}
+
+	// u32 length-prefixed UTF-16 string (not 0-terminated)
+	template<typename ArchiveT>
+	ArchiveT&
+	read_wide_string(ArchiveT& archive, wide_string& str)
+	{
+		u32 size = 0;
+		str.erase();
+		if ((archive >> size) && (size > 0)) {
+			if (size > archive::streamsize_limits<wide_char>::max_count()) {
+				archive.setstate(std::ios_base::failbit);
+			} else {
+				std::vector<wide_char> chars;
+				if (archive.read(chars, size)) {
+					str.assign(chars.begin(), chars.end());
+				}
+			}
+		}
+		return (archive);
+	}
+
+	template<typename ArchiveT>
+	ArchiveT&
+	write_wide_string(ArchiveT& archive, wide_string const& str)
+	{
+		archive << u32(str.size());
+		if (!str.empty()) {
+			archive.write(str.data(), static_cast<archive::streamsize>(str.size()));
+		}
+		return (archive);
+	}
+
+	// 0-terminated name pool of the state file (offset 0 is the empty name)
+	class state_name_pool {
+	public:
+		state_name_pool(void)
+			: m_data(1, byte_char(0))
+			, m_offs()
+		{
+		}
+		u32 add(byte_string const& name)
+		{
+			if (name.empty()) {
+				return (0);
+			}
+			std::map<byte_string, u32>::const_iterator p = m_offs.find(name);
+			if (p != m_offs.end()) {
+				return (p->second);
+			}
+			u32 const off = static_cast<u32>(m_data.size());
+			m_data.insert(m_data.end(), name.begin(), name.end());
+			m_data.push_back(byte_char(0));
+			m_offs.insert(std::make_pair(name, off));
+			return (off);
+		}
+		std::vector<byte_char> const& data(void) const
+		{
+			return (m_data);
+		}
+	private:
+		std::vector<byte_char> m_data;
+		std::map<byte_string, u32> m_offs;
+	};
+
+	byte_string
+	get_state_name(std::vector<byte_char> const& pool, u32 off)
+	{
+		if (off >= pool.size()) {
+			throw std::invalid_argument("invalid state name offset");
+		}
+		return (byte_string(&pool[off]));
+	}
+
+	// symbol chain lengths (above the valid range) for the first invalid link
+	u32 const sym_len_open    = u32(-1);  // on the current path
+	u32 const sym_len_cyclic  = u32(-2);
+	u32 const sym_len_badchar = u32(-3);
+	u32 const sym_len_badlink = u32(-4);
+
+	u32
+	bin_symbol_length(std::vector<u32> const& sym_len, u16 sym)
+	{
+		if (sym >= sym_len.size()) {
+			throw std::out_of_range("invalid string symbol index");
+		}
+		switch (sym_len[sym]) {
+		case sym_len_cyclic:
+			throw std::out_of_range("cyclic string symbol reference");
+		case sym_len_badchar:
+			throw std::out_of_range("invalid string symbol character");
+		case sym_len_badlink:
+			throw std::out_of_range("invalid string symbol reference");
+		}
+		return (sym_len[sym]);
+	}
+
 } // namespace genome::localization::{anonymous}
 
 //
@@ -394,51 +953,275 @@ stringtable::bin_source::write(oarchive& bin) const
 }
 
 //
-// stringtable::bin_table
+// stringtable::bin_image
 //
 
-void
-stringtable::bin_table::add_string(u32 seq)
-{
-	str_tab.push_back(seq);
-}
-
-void
-stringtable::bin_table::add_new_string(void)
+stringtable::bin_image::bin_image(void)
+	: hdr(0)
+	, col_idx()
+	, src_tab()
+	, col_str()
+	, col_tab()
+	, key_ref()
+	, key_tab()
+	, str_pos(0)
 {
-	add_string(get_next_sequence());
 }
 
-void
-stringtable::bin_table::add_empty_string(void)
-{
-	add_string(u32(-1));
-}
+//
+// stringtable::bin_writer
+//
 
-void
-stringtable::bin_table::add_string_sequence(std::vector<u16>& seq, bool ext)
-{
-	seq.push_back(u16(0));
-	if (ext) {
-		// AFAIK this optimization is not included in the Genome engine
-		std::vector<u16>::iterator pos = std::search(seq_tab.begin(), seq_tab.end(), seq.begin(), seq.end());
-		if (pos != seq_tab.end()) {
-			add_string(u32(std::distance(seq_tab.begin(), pos)));
+class stringtable::bin_writer {
+	bin_writer(bin_writer const&) GENOME_DELETE_FUNCTION;
+	bin_writer& operator=(bin_writer const&) GENOME_DELETE_FUNCTION;
+public:
+	// writes everything up to the first string table
+	// (into a temporary file that replaces the target in finish)
+	bin_writer(stringtable const& stb, bin_image const& img, bin_target const& target)
+		: m_stb(stb)
+		, m_img(img)
+		, m_target(target)
+		, m_temp()
+		, m_buffer()
+		, m_file()
+		, m_stream(open_stream(target, m_temp, m_buffer, m_file), target.plat)
+		, m_archive(target.output ? *target.output : static_cast<oarchive&>(m_stream))
+	{
+		try {
+			write_head();
+		} catch (...) {
+			discard();
+			throw;
+		}
+	}
+	~bin_writer(void)
+	{
+		discard();
+	}
+	void write_table(bin_table const& tab)
+	{
+		m_archive << tab.str_tab;
+		m_archive << tab.seq_tab;
+		m_archive << tab.sym_tab;
+	}
+	void finish(archive::streampos end)
+	{
+		if (!m_archive || (m_archive.tellp() != end)) {
+			throw std::runtime_error("failed to write binary string table");
+		}
+		// column table and header
+		m_archive.seekp(m_img.hdr.col_table);
+		m_archive.write(&m_img.col_tab[0].str_tab.size, m_img.hdr.col_count * 4);
+		m_archive.seekp(m_img.hdr.src_table - static_cast<archive::streamsize>(sizeof(bin_header)));
+		bin_header hdr(m_img.hdr);
+		hdr.magic = bin_header(m_target.vers).magic;
+		hdr.write(m_archive);
+		if (!m_archive) {
+			throw std::runtime_error("failed to write binary string table");
+		}
+		if (m_target.output) {
+			// the archive belongs to the caller
+			m_archive.seekp(end);
 			return;
 		}
+		m_file.close();
+		bool written = false;
+		if (m_file.fail() || !filesystem::replace_file(m_target.path.c_str(), m_temp.c_str(), m_stb.m_skip_unchanged, written)) {
+			throw std::runtime_error("failed to write binary string table");
+		}
+		m_temp.clear();
+		if (m_stb.m_skip_unchanged) {
+			std::wcout << L"output=" << (written ? L"written" : L"unchanged") << std::endl;
+		}
 	}
-	add_new_string();
-	seq_tab.insert(seq_tab.end(), seq.begin(), seq.end());
-}
-
-void
-stringtable::bin_table::add_sequence(u16 sym)
-{
-	seq_tab.push_back(sym);
-}
-
-void
-stringtable::bin_table::add_sequence_end(void)
+private:
+	static std::ostream& open_stream(bin_target const& target, std::string& temp, std::vector<char>& buffer, std::ofstream& file)
+	{
+		if (target.output) {
+			// not opened (the archive belongs to the caller)
+			return (file);
+		}
+		filesystem::ensure_directories(target.path.c_str());
+		// large file buffer (the default is a few KiB)
+		buffer.resize(1 << 20);
+		file.rdbuf()->pubsetbuf(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+		temp = filesystem::temp_file_name(target.path.c_str());
+		file.open(temp.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		return (file);
+	}
+	void write_head(void)
+	{
+		if (!m_archive || (m_archive.tellp() != m_img.hdr.src_table - static_cast<archive::streamsize>(sizeof(bin_header)))) {
+			throw std::runtime_error("failed to create binary string table");
+		}
+		// header (without signature until the file is complete)
+		bin_header hdr(m_img.hdr);
+		hdr.magic = 0;
+		hdr.write(m_archive);
+		// source table
+		for (std::vector<bin_source>::const_iterator psrc = m_img.src_tab.begin(); psrc != m_img.src_tab.end(); ++psrc) {
+			psrc->write(m_archive);
+		}
+		while (m_archive && (m_archive.tellp() % sizeof(u32))) {
+			m_archive << u8(0);
+		}
+		// column names
+		m_archive << m_img.col_str;
+		for (std::size_t i = 0; i < m_img.col_idx.size(); ++i) {
+			byte_string const& str = m_stb.m_col[m_img.col_idx[i]].name;
+			archive::streamref ref;
+			write_ref_string(m_archive, str, ref, true, archive::streamsize(sizeof(u32)));
+		}
+		// column table (written in finish)
+		m_archive.write(&m_img.col_tab[0].str_tab.size, m_img.hdr.col_count * 4);
+		// key table
+		m_archive << m_img.key_ref;
+		m_archive << m_img.key_tab;
+		if (!m_archive || (m_archive.tellp() != m_img.str_pos)) {
+			throw std::runtime_error("failed to write binary string table");
+		}
+	}
+	void discard(void)
+	{
+		// the target keeps its old content if the file is not finished
+		if (!m_temp.empty()) {
+			m_file.close();
+			std::remove(m_temp.c_str());
+			m_temp.clear();
+		}
+	}
+	stringtable const& m_stb;
+	bin_image const&   m_img;
+	bin_target const&  m_target;
+	std::string        m_temp;  // native temporary file (empty if finished)
+	std::vector<char>  m_buffer;
+	std::ofstream      m_file;
+	osarchive          m_stream;
+	oarchive&          m_archive;
+};
+
+//
+// stringtable::verify_bin_task
+//
+
+class stringtable::verify_bin_task : public parallel_task {
+public:
+	// one index per range of 'rows' id rows
+	verify_bin_task(stringtable const& stb, column const& col, key_list const& ids, bin_table const& tab, std::vector<u32> const& sym_len, std::size_t rows)
+		: m_stb(stb)
+		, m_col(col)
+		, m_ids(ids)
+		, m_tab(tab)
+		, m_sym_len(sym_len)
+		, m_rows(rows)
+	{
+	}
+	virtual void run(std::size_t index) GENOME_OVERRIDE
+	{
+		std::size_t const first = index * m_rows;
+		m_stb.verify_bin_rows(m_col, m_ids, m_tab, m_sym_len, first, std::min(first + m_rows, m_ids.size()));
+	}
+private:
+	verify_bin_task(verify_bin_task const&) GENOME_DELETE_FUNCTION;
+	verify_bin_task& operator=(verify_bin_task const&) GENOME_DELETE_FUNCTION;
+	stringtable const&      m_stb;
+	column const&           m_col;
+	key_list const&         m_ids;
+	bin_table const&        m_tab;
+	std::vector<u32> const& m_sym_len;
+	std::size_t             m_rows;
+};
+
+stringtable::packed_column::packed_column(void)
+	: revision(0)
+	, tab()
+{
+}
+
+//
+// stringtable::state_header
+//
+
+stringtable::state_header::state_header(void)
+	: magic((u32(1) << 24) | 0x00535453UL)
+	, src_count(0)
+	, map_count(0)
+	, ids_count(0)
+	, col_count(0)
+	, name_pool()
+	, text_pool()
+	, src_table(0)
+	, map_table(0)
+	, ids_table(0)
+	, col_table(0)
+{
+}
+
+iarchive&
+stringtable::state_header::read(iarchive& sta)
+{
+	return (sta >> reinterpret_cast<u32(&)[sizeof(state_header) / sizeof(u32)]>(magic));
+}
+
+oarchive&
+stringtable::state_header::write(oarchive& sta) const
+{
+	return (sta << reinterpret_cast<u32 const(&)[sizeof(state_header) / sizeof(u32)]>(magic));
+}
+
+u8
+stringtable::state_header::version(void) const
+{
+	return (static_cast<u8>(magic >> 24));
+}
+
+//
+// stringtable::bin_table
+//
+
+void
+stringtable::bin_table::add_string(u32 seq)
+{
+	str_tab.push_back(seq);
+}
+
+void
+stringtable::bin_table::add_new_string(void)
+{
+	add_string(get_next_sequence());
+}
+
+void
+stringtable::bin_table::add_empty_string(void)
+{
+	add_string(u32(-1));
+}
+
+void
+stringtable::bin_table::add_string_sequence(std::vector<u16>& seq, bool ext)
+{
+	seq.push_back(u16(0));
+	if (ext) {
+		// AFAIK this optimization is not included in the Genome engine
+		std::vector<u16>::iterator pos = std::search(seq_tab.begin(), seq_tab.end(), seq.begin(), seq.end());
+		if (pos != seq_tab.end()) {
+			add_string(u32(std::distance(seq_tab.begin(), pos)));
+			return;
+		}
+	}
+	add_new_string();
+	seq_tab.insert(seq_tab.end(), seq.begin(), seq.end());
+}
+
+void
+stringtable::bin_table::add_sequence(u16 sym)
+{
+	seq_tab.push_back(sym);
+}
+
+void
+stringtable::bin_table::add_sequence_end(void)
 {
 	add_sequence(u16(0));
 }
@@ -480,6 +1263,12 @@ stringtable::bin_table::symbols_full(void) const
 	return (u16(-1) < sym_tab.size());
 }
 
+std::size_t
+stringtable::bin_table::heap_bytes(void) const
+{
+	return (str_tab.capacity() * sizeof(u32) + seq_tab.capacity() * sizeof(u16) + sym_tab.capacity() * sizeof(u32));
+}
+
 //
 // stringtable::source
 //
@@ -536,6 +1325,149 @@ stringtable::source::set_modified(filetime const& modified)
 	m_modified = modified;
 }
 
+//
+// stringtable::name_arena
+//
+
+stringtable::name_arena::name_arena(void)
+	: m_data(1, byte_char(0))
+	, m_index()
+	, m_next()
+{
+}
+
+stringtable::name_arena::handle
+stringtable::name_arena::intern(byte_string const& str)
+{
+	if (str.empty()) {
+		return (0);
+	}
+	// exact (case-sensitive) match, like the hash
+	string_hash const h = hash_byte(str);
+	hash_table<handle>::const_iterator pos = m_index.find(h);
+	handle last = 0;
+	if (pos != m_index.end()) {
+		for (handle cur = pos->second;;) {
+			byte_char const* const name = c_str(cur);
+			if ((std::char_traits<byte_char>::length(name) == str.size()) &&
+				(0 == std::char_traits<byte_char>::compare(name, str.data(), str.size()))) {
+				return (cur);
+			}
+			last = cur;
+			std::map<handle, handle>::const_iterator next = m_next.find(cur);
+			if (next == m_next.end()) {
+				break;
+			}
+			cur = next->second;
+		}
+	}
+	handle const off = static_cast<handle>(m_data.size());
+	m_data.insert(m_data.end(), str.begin(), str.end());
+	m_data.push_back(byte_char(0));
+	if (pos == m_index.end()) {
+		m_index.insert(std::make_pair(h, off));
+	} else {
+		m_next.insert(std::make_pair(last, off));
+	}
+	return (off);
+}
+
+byte_char const*
+stringtable::name_arena::c_str(handle str) const
+{
+	return (&m_data[str]);
+}
+
+std::size_t
+stringtable::name_arena::bytes(void) const
+{
+	return (m_data.size());
+}
+
+void
+stringtable::name_arena::swap(name_arena& other)
+{
+	m_data.swap(other.m_data);
+	m_index.swap(other.m_index);
+	m_next.swap(other.m_next);
+}
+
+std::size_t
+stringtable::name_arena::heap_bytes(void) const
+{
+	return (m_data.capacity() * sizeof(byte_char) + m_index.heap_bytes());
+}
+
+void
+stringtable::name_arena::clear(void)
+{
+	m_data.assign(1, byte_char(0));
+	m_index.clear();
+	m_next.clear();
+}
+
+//
+// stringtable::id_name
+//
+
+bool
+stringtable::id_name::empty(void) const
+{
+	return (!prefix && !id);
+}
+
+//
+// stringtable::text_ref
+//
+
+stringtable::text_ref::text_ref(void)
+	: m_first(0)
+	, m_last(0)
+{
+}
+
+stringtable::text_ref::text_ref(const_iterator first, const_iterator last)
+	: m_first(first)
+	, m_last(last)
+{
+}
+
+stringtable::text_ref::const_iterator
+stringtable::text_ref::begin(void) const
+{
+	return (m_first);
+}
+
+stringtable::text_ref::const_iterator
+stringtable::text_ref::end(void) const
+{
+	return (m_last);
+}
+
+stringtable::text_ref::size_type
+stringtable::text_ref::size(void) const
+{
+	return (static_cast<size_type>(m_last - m_first));
+}
+
+bool
+stringtable::text_ref::empty(void) const
+{
+	return (m_first == m_last);
+}
+
+bool
+stringtable::text_ref::equals(wide_string const& str) const
+{
+	return ((str.size() == size()) && std::equal(m_first, m_last, str.begin()));
+}
+
+wide_string
+stringtable::text_ref::str(void) const
+{
+	return (wide_string(m_first, m_last));
+}
+
 //
 // stringtable::column
 //
@@ -543,7 +1475,12 @@ stringtable::source::set_modified(filetime const& modified)
 stringtable::column::column(byte_string const& col_name)
 	: name(col_name)
 	, name_hash(hash_name(name))
-	, rows()
+	, m_keys()
+	, m_offs(1, u32(0))
+	, m_pool()
+	, m_pending()
+	, m_pending_pool()
+	, m_revision(0)
 {
 }
 
@@ -553,15 +1490,255 @@ stringtable::column::match(byte_string const& filter) const
 	return (name_match_spec(name.c_str(), filter.c_str()));
 }
 
+bool
+stringtable::column::empty(void) const
+{
+	return (m_keys.empty());
+}
+
+stringtable::column::size_type
+stringtable::column::size(void) const
+{
+	return (m_keys.size());
+}
+
+string_hash const&
+stringtable::column::key(size_type row) const
+{
+	return (m_keys[row]);
+}
+
+stringtable::text_ref
+stringtable::column::text(size_type row) const
+{
+	wide_char const* const pool = m_pool.empty() ? 0 : &m_pool[0];
+	return (text_ref(pool + m_offs[row], pool + m_offs[row + 1]));
+}
+
+stringtable::column::size_type
+stringtable::column::find(string_hash const& key) const
+{
+	key_list::const_iterator pos = std::lower_bound(m_keys.begin(), m_keys.end(), key, key_compare());
+	if ((pos != m_keys.end()) && (*pos == key)) {
+		return (static_cast<size_type>(pos - m_keys.begin()));
+	}
+	return (m_keys.size());
+}
+
+stringtable::text_ref
+stringtable::column::find_text(string_hash const& key) const
+{
+	size_type const row = find(key);
+	return ((row < m_keys.size()) ? text(row) : text_ref());
+}
+
+stringtable::key_list const&
+stringtable::column::keys(void) const
+{
+	return (m_keys);
+}
+
+std::vector<u32> const&
+stringtable::column::offsets(void) const
+{
+	return (m_offs);
+}
+
+std::vector<wide_char> const&
+stringtable::column::pool(void) const
+{
+	return (m_pool);
+}
+
+void
+stringtable::column::set(string_hash const& key, wide_string const& str)
+{
+	set(key, str.empty() ? text_ref() : text_ref(str.data(), str.data() + str.size()));
+}
+
+void
+stringtable::column::set(string_hash const& key, text_ref const& str)
+{
+	pending_row row;
+	row.key = key;
+	row.beg = static_cast<u32>(m_pending_pool.size());
+	m_pending_pool.insert(m_pending_pool.end(), str.begin(), str.end());
+	row.end = static_cast<u32>(m_pending_pool.size());
+	m_pending.push_back(row);
+}
+
+bool
+stringtable::column::pending_row_compare::operator()(pending_row const& lhs, pending_row const& rhs) const
+{
+	return (key_compare()(lhs.key, rhs.key));
+}
+
+void
+stringtable::column::commit(void)
+{
+	if (m_pending.empty()) {
+		return;
+	}
+	// stable sort keeps the set() order of equal keys (last one wins)
+	std::stable_sort(m_pending.begin(), m_pending.end(), pending_row_compare());
+	key_list keys;
+	std::vector<u32> offs;
+	std::vector<wide_char> pool;
+	keys.reserve(m_keys.size() + m_pending.size());
+	offs.reserve(m_keys.size() + m_pending.size() + 1);
+	pool.reserve(m_pool.size() + m_pending_pool.size());
+	offs.push_back(u32(0));
+	size_type row = 0;
+	std::vector<pending_row>::const_iterator pend = m_pending.begin();
+	while ((row < m_keys.size()) || (pend != m_pending.end())) {
+		if ((pend == m_pending.end()) ||
+			((row < m_keys.size()) && key_compare()(m_keys[row], pend->key))) {
+			// unchanged row
+			keys.push_back(m_keys[row]);
+			pool.insert(pool.end(), m_pool.begin() + m_offs[row], m_pool.begin() + m_offs[row + 1]);
+			offs.push_back(static_cast<u32>(pool.size()));
+			++row;
+			continue;
+		}
+		if ((row < m_keys.size()) && (m_keys[row] == pend->key)) {
+			++row;  // replaced or removed
+		}
+		std::vector<pending_row>::const_iterator last = pend;
+		while ((++pend != m_pending.end()) && (pend->key == last->key)) {
+			last = pend;
+		}
+		if (last->beg < last->end) {
+			keys.push_back(last->key);
+			pool.insert(pool.end(), m_pending_pool.begin() + last->beg, m_pending_pool.begin() + last->end);
+			offs.push_back(static_cast<u32>(pool.size()));
+		}
+	}
+	m_keys.swap(keys);
+	m_offs.swap(offs);
+	m_pool.swap(pool);
+	std::vector<pending_row>().swap(m_pending);
+	std::vector<wide_char>().swap(m_pending_pool);
+	++m_revision;
+}
+
+void
+stringtable::column::clear(void)
+{
+	m_keys.clear();
+	m_offs.assign(1, u32(0));
+	m_pool.clear();
+	m_pending.clear();
+	m_pending_pool.clear();
+	++m_revision;
+}
+
+u32
+stringtable::column::revision(void) const
+{
+	return (m_revision);
+}
+
+std::size_t
+stringtable::column::heap_bytes(void) const
+{
+	return (name.capacity() +
+		m_keys.capacity() * sizeof(string_hash) +
+		m_offs.capacity() * sizeof(u32) +
+		m_pool.capacity() * sizeof(wide_char) +
+		m_pending.capacity() * sizeof(pending_row) +
+		m_pending_pool.capacity() * sizeof(wide_char));
+}
+
+//
+// stringtable::row_cursor
+//
+
+stringtable::row_cursor::row_cursor(key_list const& ids, column const& col, std::size_t first)
+	: m_ids(&ids)
+	, m_col(&col)
+	, m_row(0)
+	, m_index(first)
+	, m_text()
+{
+	seek();
+}
+
+bool
+stringtable::row_cursor::valid(void) const
+{
+	return (m_index < m_ids->size());
+}
+
+void
+stringtable::row_cursor::next(void)
+{
+	++m_index;
+	seek();
+}
+
+std::size_t
+stringtable::row_cursor::index(void) const
+{
+	return (m_index);
+}
+
+string_hash const&
+stringtable::row_cursor::key(void) const
+{
+	return ((*m_ids)[m_index]);
+}
+
+stringtable::text_ref const&
+stringtable::row_cursor::text(void) const
+{
+	return (m_text);
+}
+
+void
+stringtable::row_cursor::seek(void)
+{
+	m_text = text_ref();
+	if (m_index < m_ids->size()) {
+		string_hash const& key = (*m_ids)[m_index];
+		// skip column rows of other ids (sparse id lists, see save_csv)
+		key_list const& keys = m_col->keys();
+		if ((m_row < keys.size()) && key_compare()(keys[m_row], key)) {
+			column::size_type step = 1;
+			while ((m_row + step < keys.size()) && key_compare()(keys[m_row + step], key)) {
+				m_row += step;
+				step <<= 1;
+			}
+			column::size_type const last = std::min<column::size_type>(m_row + step, keys.size());
+			m_row = static_cast<column::size_type>(std::lower_bound(
+				keys.begin() + static_cast<std::ptrdiff_t>(m_row + 1),
+				keys.begin() + static_cast<std::ptrdiff_t>(last),
+				key, key_compare()) - keys.begin());
+		}
+		if ((m_row < m_col->size()) && (m_col->key(m_row) == key)) {
+			m_text = m_col->text(m_row);
+			++m_row;
+		}
+	}
+}
+
 //
 // stringtable
 //
 
 stringtable::stringtable(void)
-	: m_map()
+	: m_names()
+	, m_map()
 	, m_src()
 	, m_ids()
 	, m_col()
+	, m_id_keys()
+	, m_skip_unchanged(false)
+	, m_verify_bin(false)
+	, m_keep_packed(false)
+	, m_pack_cache()
+	, m_pack_cache_limit(0)
+	, m_packed()
+	, m_packed_ids(0)
 {
 }
 
@@ -576,7 +1753,52 @@ stringtable::clear(void)
 	m_map.clear();
 	m_src.clear();
 	m_ids.clear();
+	m_id_keys.clear();
 	m_col.clear();
+	m_names.clear();
+	m_packed.clear();
+	m_packed_ids = 0;
+}
+
+void
+stringtable::swap_tables(stringtable& other)
+{
+	m_names.swap(other.m_names);
+	m_map.swap(other.m_map);
+	m_src.swap(other.m_src);
+	m_ids.swap(other.m_ids);
+	m_id_keys.swap(other.m_id_keys);
+	m_col.swap(other.m_col);
+	m_packed.swap(other.m_packed);
+	std::swap(m_packed_ids, other.m_packed_ids);
+}
+
+void
+stringtable::set_skip_unchanged(bool skip)
+{
+	m_skip_unchanged = skip;
+}
+
+void
+stringtable::set_verify_bin(bool verify)
+{
+	m_verify_bin = verify;
+}
+
+void
+stringtable::set_keep_packed(bool keep)
+{
+	m_keep_packed = keep;
+	if (!keep) {
+		m_packed.clear();
+	}
+}
+
+void
+stringtable::set_pack_cache(char const* cache_dir, u64 size_limit)
+{
+	m_pack_cache.assign((cache_dir && size_limit) ? cache_dir : "");
+	m_pack_cache_limit = m_pack_cache.empty() ? 0 : size_limit;
 }
 
 stringtable::source&
@@ -612,12 +1834,14 @@ stringtable::read_map(char const* csv_path)
 {
 	std::string fname((csv_path && *csv_path) ? csv_path : "#G3:/lianzifu.csv");
 	std::wcout << L"[" << genome::to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("read_map", fname);
 	u16itfstream ift(fname.c_str(), tstream::encoding_utf8);
 	if (!ift) {
 		throw std::runtime_error("failed to open idname mapping file");
 	}
 	u32 lno = 0;
 	u32 cnt = 0;
+	std::vector<map_line> lines;
 	u16itfstream::string_type str;
 	while (!ift.eof() && ift.getline(str)) {
 		++lno;
@@ -633,24 +1857,31 @@ stringtable::read_map(char const* csv_path)
 			}
 			continue;
 		}
-		byte_string name;
-		if (!string_convert(str, name)) {
-			std::wclog << L";warn: invalid characters in " << to_wstring(fname) << L"," << to_wstring(lno) << std::endl;
+		map_line& line = *lines.insert(lines.end(), map_line());
+		line.lno = lno;
+		line.valid = string_convert(str, line.name);
+		line.id_pos = line.name.find_first_of(byte_code::colon) + 1;
+	}
+	m_map.reserve(m_map.size() + lines.size());
+	for (std::size_t i = 0; i < lines.size(); ++i) {
+		map_line const& line = lines[i];
+		byte_string const& name = line.name;
+		if (!line.valid) {
+			std::wclog << L";warn: invalid characters in " << to_wstring(fname) << L"," << to_wstring(line.lno) << std::endl;
 			continue;
 		}
-		byte_string id(name, name.find_first_of(byte_code::colon) + 1);
-		if (id.empty() || (id.find_first_of(byte_code::colon) != byte_string::npos)) {
-			std::wclog << L";warn: invalid identifier in " << to_wstring(fname) << L"," << to_wstring(lno) << std::endl;
+		if ((line.id_pos >= name.size()) || (name.find_first_of(byte_code::colon, line.id_pos) != byte_string::npos)) {
+			std::wclog << L";warn: invalid identifier in " << to_wstring(fname) << L"," << to_wstring(line.lno) << std::endl;
 			continue;
 		}
-		string_hash key = hash_name(id);
-		std::pair<name_map::iterator, bool> p = m_map.insert(std::make_pair(key, name));
+		string_hash const key = hash_name(name.c_str() + line.id_pos);
+		std::pair<name_map::iterator, bool> p = m_map.insert(std::make_pair(key, intern_name(name)));
 		if (!p.second) {
-			byte_string const& n = p.first->second;
+			byte_string const n(make_name(p.first->second));
 			if (name_traits::compare(n.c_str(), name.c_str(), std::max<std::size_t>(n.size(), name.size()) + 1)) {
-				std::wclog << L";warn: hash collison between '" << to_wstring(n) << L"' and '" << to_wstring(name) << L"' in " << to_wstring(fname) << L"," << to_wstring(lno) << std::endl;
+				std::wclog << L";warn: hash collison between '" << to_wstring(n) << L"' and '" << to_wstring(name) << L"' in " << to_wstring(fname) << L"," << to_wstring(line.lno) << std::endl;
 			} else {
-				std::wclog << L";info: duplicate entry in " << to_wstring(fname) << L"," << to_wstring(lno) << std::endl;
+				std::wclog << L";info: duplicate entry in " << to_wstring(fname) << L"," << to_wstring(line.lno) << std::endl;
 			}
 		} else {
 			++cnt;
@@ -659,6 +1890,11 @@ stringtable::read_map(char const* csv_path)
 	if (!ift) {
 		throw std::runtime_error("failed to read idname mapping file line " + to_string(lno));
 	}
+	prof.add_items(lno);
+	u64 fsize = 0;
+	if (filesystem::get_file_size(fname.c_str(), fsize)) {
+		prof.add_bytes_in(fsize);
+	}
 	std::wcout << L"idname.lines=" << to_wstring(lno) << std::endl;
 	std::wcout << L"idname.valid=" << to_wstring(cnt) << std::endl;
 	std::wcout << L"idname.count=" << to_wstring(m_map.size()) << std::endl;
@@ -670,8 +1906,19 @@ stringtable::read_bin(char const* bin_path)
 {
 	std::string fname((bin_path && *bin_path) ? bin_path : "#G3:/data/compiled/localization/w_strings.bin");
 	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("read_bin", fname);
 	ifarchive ifa(fname.c_str());
-	bin_header hdr(ifa);
+	read_bin(ifa);
+	u64 fsize = 0;
+	if (filesystem::get_file_size(fname.c_str(), fsize)) {
+		prof.add_bytes_in(fsize);
+	}
+}
+
+void
+stringtable::read_bin(iarchive& bin)
+{
+	bin_header hdr(bin);
 	std::wcout << L"version=" << to_wstring(hdr.version()) << std::endl;
 	std::wcout << L"reserved=" << to_wstring(hdr.reserved) << std::endl;
 	std::wcout << L"source.count=" << to_wstring(hdr.src_count) << std::endl;
@@ -681,8 +1928,8 @@ stringtable::read_bin(char const* bin_path)
 	std::wcout << L"idhash.table=0x" << to_wstring(hash_to_string(hdr.key_table)) << std::endl;
 	std::wcout << L"column.names=0x" << to_wstring(hash_to_string(hdr.col_names)) << std::endl;
 	std::wcout << L"column.table=0x" << to_wstring(hash_to_string(hdr.col_table)) << std::endl;
-	read_bin_src(ifa, hdr);
-	read_bin_col(ifa, hdr, read_bin_ids(ifa, hdr));
+	read_bin_src(bin, hdr);
+	read_bin_col(bin, hdr, read_bin_ids(bin, hdr));
 	std::wcout << std::endl;
 }
 
@@ -725,10 +1972,10 @@ stringtable::read_bin_ids(iarchive& bin, bin_header const& hdr)
 		if (!bin.read(keys, hdr.row_count)) {
 			throw std::invalid_argument("failed to read idhash table");
 		}
-		name_map::iterator id = m_ids.end();
+		m_ids.reserve(m_ids.size() + keys.size());
 		for (key_list::const_iterator i = keys.begin(); i != keys.end(); ++i) {
 			string_hash const& key = *i;
-			id = m_ids.insert(id, std::make_pair(key, byte_string()));
+			name_map::iterator id = m_ids.insert(std::make_pair(key, id_name())).first;
 			if (id->second.empty()) {
 				name_map::const_iterator name = m_map.find(id->first);
 				if (name != m_map.end()) {
@@ -738,137 +1985,439 @@ stringtable::read_bin_ids(iarchive& bin, bin_header const& hdr)
 			} else {
 				++cnt;
 			}
-			++id;
 		}
 	}
-	std::wcout << L"idhash.names=" << to_wstring(cnt) << std::endl;
-	return (keys);
+	std::wcout << L"idhash.names=" << to_wstring(cnt) << std::endl;
+	return (keys);
+}
+
+void
+stringtable::read_bin_col(iarchive& bin, bin_header const& hdr, key_list const& ids)
+{
+	if (hdr.col_count > 0) {
+		std::vector<std::size_t> col_indices;
+		{
+			std::vector<archive::streamref> refs;
+			if (!bin.seekg(hdr.col_names) || !bin.read(refs, hdr.col_count)) {
+				throw std::invalid_argument("invalid column name table offset");
+			}
+			for (archive::streamsize i = 0; i < hdr.col_count; ++i) {
+				byte_string name;
+				if (!read_ref_string(bin, refs[i], name) || name.empty()) {
+					throw std::invalid_argument("invalid column name reference");
+				}
+				col_indices.push_back(add_col(name));
+				std::wcout << L"column.name." << to_wstring(i + 1) << L"=" << to_wstring(name) << std::endl;
+			}
+		}
+		{
+			std::vector<bin_column> refs;
+			refs.resize(hdr.col_count);
+			if (!bin.seekg(hdr.col_table) || !bin.read(&refs[0].str_tab.size, hdr.col_count * 4)) {
+				throw std::invalid_argument("invalid column data table offset");
+			}
+			for (std::size_t i = 0; i < hdr.col_count; ++i) {
+				bin_column const& ref = refs[i];
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".strings=0x" << to_wstring(hash_to_string(ref.str_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.str_tab.size)) << L"]" << std::endl;
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".symbols=0x" << to_wstring(hash_to_string(ref.sym_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.sym_tab.size)) << L"]" << std::endl;
+
+				// u32[row_count] indices to first symbol sequence
+				// u16[] indices to symbol sequences, 0-terminated
+				std::vector<u32> str_beg;
+				std::vector<u16> str_seq;
+				if ((ref.str_tab.size < hdr.row_count * sizeof(u32)) ||
+					!bin.seekg(ref.str_tab.pos) ||
+					!bin.read(str_beg, hdr.row_count) ||
+					!bin.read(str_seq, (ref.str_tab.size - (hdr.row_count * sizeof(u32))) / sizeof(u16))) {
+					throw std::invalid_argument("invalid string table reference");
+				}
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".seq_num=" << to_wstring(str_seq.size()) << std::endl;
+
+				// u32[] symbol table, low u16 prev symbol (0 = rend), high u16 UTF-16 code
+				std::vector<u32> seq_sym;
+				if (!bin.seekg(ref.sym_tab.pos) ||
+					!bin.read(seq_sym, ref.sym_tab.size / sizeof(u32))) {
+					throw std::invalid_argument("invalid symbol table reference");
+				}
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".sym_num=" << to_wstring(seq_sym.size()) << std::endl;
+
+				std::vector<u32> sym_len;
+				u32 const max_len = link_bin_symbols(seq_sym, sym_len);
+				if (max_len > max_sequence_length) {
+					std::wclog << L";warn: symbol chain length " << to_wstring(max_len) << L" exceeds " << to_wstring(u32(max_sequence_length)) << L" in column " << to_wstring(i + 1) << std::endl;
+				}
+
+				wide_string::size_type max_sub = 0;
+				wide_string::size_type max_str = 0;
+				column& col = m_col[col_indices[i]];
+				for (archive::streamsize j = 0; j < hdr.row_count; ++j) {
+					string_hash const& key = ids[j];
+					u32 const beg = str_beg[j];
+					if (u32(-1) == beg) {  // empty string
+						// remove existing string (merge)
+						if (!col.find_text(key).empty()) {
+							col.set(key, text_ref());
+
+							if (logger::enabled(logger::level_info)) {
+								byte_string name = get_id_name(key);
+								name.push_back(byte_code::percent_sign);
+								name.append(col.name);
+								std::wclog << L";info: [merge] removed " << to_wstring(name) << std::endl;
+							}
+						}
+						continue;
+					}
+					wide_string str;
+					decode_bin_string(str_seq, seq_sym, sym_len, beg, str, max_sub);
+					if (max_str < str.size()) {
+						max_str = str.size();
+					}
+					text_ref const val = col.find_text(key);
+					if (val.empty()) {
+						col.set(key, str);
+					} else {
+						// update existing string (merge)
+						if (!val.equals(str)) {
+							col.set(key, str);
+
+							if (logger::enabled(logger::level_info)) {
+								byte_string name = get_id_name(key);
+								name.push_back(byte_code::percent_sign);
+								name.append(col.name);
+								std::wclog << L";info: [merge] changed " << to_wstring(name) << std::endl;
+							}
+						}
+					}
+				}
+				col.commit();
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".max_sub=" << to_wstring(max_sub) << std::endl;
+				std::wcout << L"column.data." << to_wstring(i + 1) << L".max_str=" << to_wstring(max_str) << std::endl;
+			}
+		}
+	}
+}
+
+u32
+stringtable::link_bin_symbols(std::vector<u32> const& seq_sym, std::vector<u32>& sym_len)
+{
+	// every symbol is visited once (not per string), with the chain length
+	// or the error that decoding this symbol would run into (0 = unknown)
+	sym_len.assign(seq_sym.size(), 0);
+	std::vector<u32> path;
+	u32 max_len = 0;
+	for (u32 i = 0; i < seq_sym.size(); ++i) {
+		// follow the links up to the chain end or a known symbol
+		u32 len = 0;
+		for (u32 s = i;;) {
+			if (sym_len_open == sym_len[s]) {
+				len = sym_len_cyclic;
+				break;
+			} else if (sym_len[s]) {
+				len = sym_len[s];
+				break;
+			}
+			sym_len[s] = sym_len_open;
+			path.push_back(s);
+			u32 const p = seq_sym[s] & 0xFFFFU;
+			if (0 == p) {
+				break;
+			} else if (p >= seq_sym.size()) {
+				len = sym_len_badlink;
+				break;
+			}
+			s = p;
+		}
+		// and back again (the character is checked before the link)
+		while (!path.empty()) {
+			u32 const c = path.back();
+			path.pop_back();
+			if (0 == ((seq_sym[c] >> 16) & 0xFFFFU)) {
+				len = sym_len_badchar;
+			} else if (len < sym_len_badlink) {
+				if (max_len < ++len) {
+					max_len = len;
+				}
+			}
+			sym_len[c] = len;
+		}
+	}
+	return (max_len);
+}
+
+void
+stringtable::decode_bin_string(std::vector<u16> const& str_seq, std::vector<u32> const& seq_sym, std::vector<u32> const& sym_len, u32 beg, wide_string& str, wide_string::size_type& max_sub)
+{
+	str.erase();
+	if (beg >= str_seq.size()) {
+		throw std::out_of_range("invalid string sequence index");
+	}
+	std::vector<u16>::const_iterator seq = str_seq.begin();
+	std::advance(seq, beg);
+	do {
+		u32 const len = bin_symbol_length(sym_len, *seq);
+		if (max_sub < len) {
+			max_sub = len;
+		}
+		// validated chain (written back to front)
+		//TODO: scan for invalid UTF-16 code sequences
+		wide_string::size_type pos = str.size() + len;
+		str.resize(pos);
+		for (u32 sym = seq_sym[*seq];; sym = seq_sym[sym & 0xFFFFU]) {
+			str[--pos] = static_cast<wide_char>((sym >> 16) & 0xFFFFU);
+			if (0 == (sym & 0xFFFFU)) {
+				break;
+			}
+		}
+		if (str_seq.end() == ++seq) {
+			throw std::overflow_error("unterminated string sequence");
+		}
+	} while (*seq);
+}
+
+void
+stringtable::verify_bin_table(col_list::size_type col_idx, key_list const& ids, bin_table const& tab) const
+{
+	column const& col = m_col[col_idx];
+	if (tab.str_tab.size() != ids.size()) {
+		throw std::runtime_error("verification failed for column " + to_string(col.name) + " (invalid string count)");
+	}
+	profile::scope prof("verify_bin", to_string(col.name));
+	prof.add_items(ids.size());
+	// decoded like read_bin_col, compared with the column strings
+	// (row ranges on the worker threads, a few per thread)
+	std::vector<u32> sym_len;
+	link_bin_symbols(tab.sym_tab, sym_len);
+	std::size_t const ranges = parallel_concurrency() * 4;
+	std::size_t const rows = std::max<std::size_t>((ids.size() + ranges - 1) / ranges, 4096);
+	verify_bin_task task(*this, col, ids, tab, sym_len, rows);
+	parallel_for(task, (ids.size() + rows - 1) / rows);
+}
+
+void
+stringtable::verify_bin_rows(column const& col, key_list const& ids, bin_table const& tab, std::vector<u32> const& sym_len, std::size_t first, std::size_t last) const
+{
+	wide_string str;
+	for (row_cursor row(ids, col, first); row.valid() && (row.index() < last); row.next()) {
+		u32 const beg = tab.str_tab[row.index()];
+		std::string error;
+		if (u32(-1) == beg) {
+			if (!row.text().empty()) {
+				error = "missing string";
+			}
+		} else {
+			wide_string::size_type max_sub = 0;
+			try {
+				decode_bin_string(tab.seq_tab, tab.sym_tab, sym_len, beg, str, max_sub);
+				if (max_sub > max_sequence_length) {
+					error = "symbol sequence too long";
+				} else if (!row.text().equals(str)) {
+					error = "different string";
+				}
+			} catch (std::exception& e) {
+				error = e.what();
+			}
+		}
+		if (!error.empty()) {
+			byte_string name = get_id_name(row.key());
+			name.push_back(byte_code::percent_sign);
+			name.append(col.name);
+			throw std::runtime_error("verification failed for " + to_string(name) + " (" + error + ")");
+		}
+	}
+}
+
+//
+// stringtable::bin_info_task
+//
+
+class stringtable::bin_info_task : public parallel_task {
+public:
+	// one index per file
+	explicit bin_info_task(std::vector<std::string> const& paths)
+		: m_paths(paths)
+		, m_info(paths.size())
+		, m_failed(paths.size(), 0)
+	{
+	}
+	virtual void run(std::size_t index) GENOME_OVERRIDE
+	{
+		std::wostringstream out;
+		try {
+			std::vector<u8> data;
+			if (!filesystem::read_file(m_paths[index].c_str(), data)) {
+				throw std::runtime_error("failed to read binary string table");
+			}
+			imarchive bin(data);
+			inspect_bin(bin, out);
+		} catch (std::exception& e) {
+			out << L"error=" << to_wstring(std::string(e.what())) << std::endl;
+			m_failed[index] = 1;
+		}
+		m_info[index] = out.str();
+	}
+	std::size_t print(void) const
+	{
+		std::size_t failed = 0;
+		for (std::size_t i = 0; i < m_paths.size(); ++i) {
+			std::wcout << L"[" << to_wstring(m_paths[i]) << L"]" << std::endl;
+			std::wcout << m_info[i] << std::endl;
+			failed += m_failed[i];
+		}
+		std::wcout << L"bin.count=" << to_wstring(m_paths.size()) << std::endl;
+		std::wcout << L"bin.failed=" << to_wstring(failed) << std::endl;
+		std::wcout << std::endl;
+		return (failed);
+	}
+private:
+	bin_info_task(bin_info_task const&) GENOME_DELETE_FUNCTION;
+	bin_info_task& operator=(bin_info_task const&) GENOME_DELETE_FUNCTION;
+	std::vector<std::string> const& m_paths;
+	std::vector<std::wstring>       m_info;
+	std::vector<u8>                 m_failed;  // per index (no locking)
+};
+
+void
+stringtable::print_bin_info(std::vector<std::string> const& bin_paths)
+{
+	// all files on the worker threads, printed in argument order
+	bin_info_task task(bin_paths);
+	parallel_for(task, bin_paths.size());
+	std::size_t const failed = task.print();
+	if (failed > 0) {
+		throw std::runtime_error("failed to inspect " + to_string(failed) + " binary string table(s)");
+	}
+}
+
+void
+stringtable::print_memory(void) const
+{
+	std::wcout << L"[memory]" << std::endl;
+	profile::memory_usage const heap = profile::memory();
+	std::wcout << L"heap.allocs=" << to_wstring(heap.allocs) << std::endl;
+	std::wcout << L"heap.live=" << to_wstring(heap.live_bytes) << std::endl;
+	std::wcout << L"heap.peak=" << to_wstring(heap.peak_bytes) << std::endl;
+	std::wcout << L"rss.peak=" << to_wstring(heap.peak_rss) << std::endl;
+	std::wcout << L"names.bytes=" << to_wstring(m_names.heap_bytes()) << std::endl;
+	std::wcout << L"idname.count=" << to_wstring(m_map.size()) << std::endl;
+	std::wcout << L"idname.bytes=" << to_wstring(m_map.heap_bytes()) << std::endl;
+	std::wcout << L"idhash.count=" << to_wstring(m_ids.size()) << std::endl;
+	std::wcout << L"idhash.bytes=" << to_wstring(m_ids.heap_bytes()) << std::endl;
+	std::wcout << L"column.count=" << to_wstring(m_col.size()) << std::endl;
+	for (col_list::size_type i = 0; i < m_col.size(); ++i) {
+		column const& col = m_col[i];
+		std::wcout << L"column.name." << to_wstring(i + 1) << L"=" << to_wstring(col.name) << std::endl;
+		std::wcout << L"column.rows." << to_wstring(i + 1) << L"=" << to_wstring(col.size()) << std::endl;
+		std::wcout << L"column.bytes." << to_wstring(i + 1) << L"=" << to_wstring(col.heap_bytes()) << std::endl;
+	}
+	std::size_t packed_bytes = 0;
+	for (packed_column_map::const_iterator i = m_packed.begin(); i != m_packed.end(); ++i) {
+		packed_bytes += i->second.tab.heap_bytes();
+	}
+	std::wcout << L"packed.count=" << to_wstring(m_packed.size()) << std::endl;
+	std::wcout << L"packed.bytes=" << to_wstring(packed_bytes) << std::endl;
+	std::wcout << L"suffix_tree.allocs=" << to_wstring(stb_stats.allocs) << std::endl;
+	std::wcout << L"suffix_tree.live=" << to_wstring(stb_stats.live_bytes) << std::endl;
+	std::wcout << L"suffix_tree.peak=" << to_wstring(stb_stats.peak_bytes) << std::endl;
+	std::wcout << std::endl;
+}
+
+void
+stringtable::inspect_bin(iarchive& bin, std::wostream& out)
+{
+	// same keys as read_bin, but without the id table and the strings
+	bin_header hdr(bin);
+	out << L"version=" << to_wstring(hdr.version()) << std::endl;
+	out << L"reserved=" << to_wstring(hdr.reserved) << std::endl;
+	out << L"source.count=" << to_wstring(hdr.src_count) << std::endl;
+	out << L"column.count=" << to_wstring(hdr.col_count) << std::endl;
+	out << L"string.count=" << to_wstring(hdr.row_count) << std::endl;
+	out << L"source.table=0x" << to_wstring(hash_to_string(hdr.src_table)) << std::endl;
+	out << L"idhash.table=0x" << to_wstring(hash_to_string(hdr.key_table)) << std::endl;
+	out << L"column.names=0x" << to_wstring(hash_to_string(hdr.col_names)) << std::endl;
+	out << L"column.table=0x" << to_wstring(hash_to_string(hdr.col_table)) << std::endl;
+	if (hdr.src_count > 0) {
+		if (!bin.seekg(hdr.src_table)) {
+			throw std::invalid_argument("invalid source table offset");
+		}
+		for (archive::streamsize i = 0; i < hdr.src_count; ++i) {
+			bin_source src(bin);
+			if (!bin) {
+				throw std::invalid_argument("failed to read source entry #" + to_string(i + 1));
+			}
+			out << L"source." << to_wstring(i + 1) << L"=" << to_wstring(src.modified) << L" " << to_wstring(src.csv_path) << std::endl;
+		}
+	}
+	if (hdr.col_count > 0) {
+		std::vector<archive::streamref> names;
+		if (!bin.seekg(hdr.col_names) || !bin.read(names, hdr.col_count)) {
+			throw std::invalid_argument("invalid column name table offset");
+		}
+		for (archive::streamsize i = 0; i < hdr.col_count; ++i) {
+			byte_string name;
+			if (!read_ref_string(bin, names[i], name) || name.empty()) {
+				throw std::invalid_argument("invalid column name reference");
+			}
+			out << L"column.name." << to_wstring(i + 1) << L"=" << to_wstring(name) << std::endl;
+		}
+		std::vector<bin_column> refs(hdr.col_count);
+		if (!bin.seekg(hdr.col_table) || !bin.read(&refs[0].str_tab.size, hdr.col_count * 4)) {
+			throw std::invalid_argument("invalid column data table offset");
+		}
+		for (std::size_t i = 0; i < hdr.col_count; ++i) {
+			bin_column const& ref = refs[i];
+			out << L"column.data." << to_wstring(i + 1) << L".strings=0x" << to_wstring(hash_to_string(ref.str_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.str_tab.size)) << L"]" << std::endl;
+			out << L"column.data." << to_wstring(i + 1) << L".symbols=0x" << to_wstring(hash_to_string(ref.sym_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.sym_tab.size)) << L"]" << std::endl;
+			std::vector<u32> str_beg;
+			std::vector<u16> str_seq;
+			if ((ref.str_tab.size < hdr.row_count * sizeof(u32)) ||
+				!bin.seekg(ref.str_tab.pos) ||
+				!bin.read(str_beg, hdr.row_count) ||
+				!bin.read(str_seq, (ref.str_tab.size - (hdr.row_count * sizeof(u32))) / sizeof(u16))) {
+				throw std::invalid_argument("invalid string table reference");
+			}
+			out << L"column.data." << to_wstring(i + 1) << L".seq_num=" << to_wstring(str_seq.size()) << std::endl;
+			std::vector<u32> seq_sym;
+			if (!bin.seekg(ref.sym_tab.pos) ||
+				!bin.read(seq_sym, ref.sym_tab.size / sizeof(u32))) {
+				throw std::invalid_argument("invalid symbol table reference");
+			}
+			out << L"column.data." << to_wstring(i + 1) << L".sym_num=" << to_wstring(seq_sym.size()) << std::endl;
+			wide_string::size_type max_sub = 0;
+			wide_string::size_type max_str = 0;
+			measure_bin_table(str_beg, str_seq, seq_sym, max_sub, max_str);
+			out << L"column.data." << to_wstring(i + 1) << L".max_sub=" << to_wstring(max_sub) << std::endl;
+			out << L"column.data." << to_wstring(i + 1) << L".max_str=" << to_wstring(max_str) << std::endl;
+		}
+	}
 }
 
 void
-stringtable::read_bin_col(iarchive& bin, bin_header const& hdr, key_list const& ids)
+stringtable::measure_bin_table(std::vector<u32> const& str_beg, std::vector<u16> const& str_seq, std::vector<u32> const& seq_sym, wide_string::size_type& max_sub, wide_string::size_type& max_str)
 {
-	if (hdr.col_count > 0) {
-		std::vector<std::size_t> col_indices;
-		{
-			std::vector<archive::streamref> refs;
-			if (!bin.seekg(hdr.col_names) || !bin.read(refs, hdr.col_count)) {
-				throw std::invalid_argument("invalid column name table offset");
-			}
-			for (archive::streamsize i = 0; i < hdr.col_count; ++i) {
-				byte_string name;
-				if (!read_ref_string(bin, refs[i], name) || name.empty()) {
-					throw std::invalid_argument("invalid column name reference");
-				}
-				col_indices.push_back(add_col(name));
-				std::wcout << L"column.name." << to_wstring(i + 1) << L"=" << to_wstring(name) << std::endl;
-			}
+	// the strings are measured as the sum of their symbol chains (not decoded)
+	std::vector<u32> sym_len;
+	link_bin_symbols(seq_sym, sym_len);
+	for (std::vector<u32>::const_iterator pbeg = str_beg.begin(); pbeg != str_beg.end(); ++pbeg) {
+		if (u32(-1) == *pbeg) {
+			continue;
+		} else if (*pbeg >= str_seq.size()) {
+			throw std::out_of_range("invalid string sequence index");
 		}
-		{
-			std::vector<bin_column> refs;
-			refs.resize(hdr.col_count);
-			if (!bin.seekg(hdr.col_table) || !bin.read(&refs[0].str_tab.size, hdr.col_count * 4)) {
-				throw std::invalid_argument("invalid column data table offset");
+		wide_string::size_type len = 0;
+		std::vector<u16>::const_iterator seq = str_seq.begin();
+		std::advance(seq, *pbeg);
+		do {
+			u32 const sub = bin_symbol_length(sym_len, *seq);
+			if (max_sub < sub) {
+				max_sub = sub;
 			}
-			for (std::size_t i = 0; i < hdr.col_count; ++i) {
-				bin_column const& ref = refs[i];
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".strings=0x" << to_wstring(hash_to_string(ref.str_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.str_tab.size)) << L"]" << std::endl;
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".symbols=0x" << to_wstring(hash_to_string(ref.sym_tab.pos)) << L"[0x" << to_wstring(hash_to_string(ref.sym_tab.size)) << L"]" << std::endl;
-
-				// u32[row_count] indices to first symbol sequence
-				// u16[] indices to symbol sequences, 0-terminated
-				std::vector<u32> str_beg;
-				std::vector<u16> str_seq;
-				if ((ref.str_tab.size < hdr.row_count * sizeof(u32)) ||
-					!bin.seekg(ref.str_tab.pos) ||
-					!bin.read(str_beg, hdr.row_count) ||
-					!bin.read(str_seq, (ref.str_tab.size - (hdr.row_count * sizeof(u32))) / sizeof(u16))) {
-					throw std::invalid_argument("invalid string table reference");
-				}
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".seq_num=" << to_wstring(str_seq.size()) << std::endl;
-
-				// u32[] symbol table, low u16 prev symbol (0 = rend), high u16 UTF-16 code
-				std::vector<u32> seq_sym;
-				if (!bin.seekg(ref.sym_tab.pos) ||
-					!bin.read(seq_sym, ref.sym_tab.size / sizeof(u32))) {
-					throw std::invalid_argument("invalid symbol table reference");
-				}
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".sym_num=" << to_wstring(seq_sym.size()) << std::endl;
-
-				wide_string::size_type max_sub = 0;
-				wide_string::size_type max_str = 0;
-				column& col = m_col[col_indices[i]];
-				for (archive::streamsize j = 0; j < hdr.row_count; ++j) {
-					string_hash const& key = ids[j];
-					u32 const beg = str_beg[j];
-					if (u32(-1) == beg) {  // empty string
-						// remove existing string (merge)
-						text_map::iterator pos = col.rows.find(key);
-						if (pos != col.rows.end()) {
-							col.rows.erase(pos);
-
-							byte_string name = get_id_name(key);
-							name.push_back(byte_code::percent_sign);
-							name.append(col.name);
-							std::wclog << L";info: [merge] removed " << to_wstring(name) << std::endl;
-						}
-						continue;
-					} else if (beg >= str_seq.size()) {
-						throw std::out_of_range("invalid string sequence index");
-					}
-					wide_string str;
-					std::vector<u16>::const_iterator seq = str_seq.begin();
-					std::advance(seq, beg);
-					do {
-						if (*seq >= seq_sym.size()) {
-							throw std::out_of_range("invalid string symbol index");
-						}
-						wide_string sub;
-						u32 sym = seq_sym[*seq];
-						//TODO: scan for invalid UTF-16 code sequences
-						for (;;) {
-							wide_char const c = static_cast<wide_char>((sym >> 16) & 0xFFFFU);
-							if (0 == c) {
-								throw std::out_of_range("invalid string symbol character");
-							}
-							sub.push_back(c);
-							u16 const p = static_cast<u16>(sym & 0xFFFFU);
-							if (0 == p) {
-								break;
-							}
-							if (p >= seq_sym.size()) {
-								throw std::out_of_range("invalid string symbol reference");
-							}
-							sym = seq_sym[p];
-						}
-						if (max_sub < sub.size()) {
-							max_sub = sub.size();
-						}
-						str.append(sub.rbegin(), sub.rend());
-						if (str_seq.end() == ++seq) {
-							throw std::overflow_error("unterminated string sequence");
-						}
-					} while (*seq);
-					if (max_str < str.size()) {
-						max_str = str.size();
-					}
-					std::pair<text_map::iterator, bool> row = col.rows.insert(std::make_pair(key, str));
-					if (!row.second) {
-						// update existing string (merge)
-						wide_string& val = row.first->second;
-						if (val.compare(str) != 0) {
-							val.assign(str);
-
-							byte_string name = get_id_name(key);
-							name.push_back(byte_code::percent_sign);
-							name.append(col.name);
-							std::wclog << L";info: [merge] changed " << to_wstring(name) << std::endl;
-						}
-					}
-				}
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".max_sub=" << to_wstring(max_sub) << std::endl;
-				std::wcout << L"column.data." << to_wstring(i + 1) << L".max_str=" << to_wstring(max_str) << std::endl;
+			len += sub;
+			if (str_seq.end() == ++seq) {
+				throw std::overflow_error("unterminated string sequence");
 			}
+		} while (*seq);
+		if (max_str < len) {
+			max_str = len;
 		}
 	}
 }
@@ -880,6 +2429,7 @@ stringtable::read_ini(char const* ini_path)
 	// case-sensitive "csv=" and whitespace is not skipped/ignored)
 	std::string fname((ini_path && *ini_path) ? ini_path : "#G3:/ini/loc.ini");
 	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("read_ini", fname);
 	witfstream ift(fname.c_str());
 	if (!ift) {
 		throw std::runtime_error("failed to open localization config file");
@@ -911,13 +2461,69 @@ stringtable::read_ini(char const* ini_path)
 					src.set_prefix(prefix);
 				}
 				std::wcout << to_wstring(prefix) << L"=" << to_wstring(csv) << std::endl;
+				prof.add_items(1);
 			}
 			prefix.clear();
 		}
 	}
+	u64 fsize = 0;
+	if (filesystem::get_file_size(fname.c_str(), fsize)) {
+		prof.add_bytes_in(fsize);
+	}
 	std::wcout << std::endl;
 }
 
+//
+// stringtable::save_csv_task
+//
+
+class stringtable::save_csv_task : public parallel_task {
+public:
+	// one index per source
+	save_csv_task(stringtable const& stb, std::vector<key_list> const& ids, std::vector<std::vector<name_arena::handle> > const& names, wide_string const& head)
+		: m_stb(stb)
+		, m_ids(ids)
+		, m_names(names)
+		, m_head(head)
+		, m_done(stb.m_src.size(), 0)
+	{
+	}
+	virtual void run(std::size_t index) GENOME_OVERRIDE
+	{
+		std::string const csv(to_string(m_stb.m_src[index].get_csv()));
+		m_done[index] = m_stb.save_csv_src(csv, m_ids[index], m_names[index], m_head) ? done_written : done_unchanged;
+	}
+	void print(void) const
+	{
+		std::size_t written = 0;
+		std::size_t skipped = 0;
+		for (std::size_t i = 0; i < m_done.size(); ++i) {
+			if (m_done[i]) {
+				std::wcout << L"[" << to_wstring(to_string(m_stb.m_src[i].get_csv())) << L"]" << std::endl;
+				if (m_stb.m_skip_unchanged) {
+					std::wcout << L"output=" << ((done_written == m_done[i]) ? L"written" : L"unchanged") << std::endl;
+				}
+				std::wcout << std::endl;
+				++((done_written == m_done[i]) ? written : skipped);
+			}
+		}
+		if (m_stb.m_skip_unchanged) {
+			std::wcout << L"csv.written=" << to_wstring(written) << std::endl;
+			std::wcout << L"csv.skipped=" << to_wstring(skipped) << std::endl;
+			std::wcout << std::endl;
+		}
+	}
+private:
+	save_csv_task(save_csv_task const&) GENOME_DELETE_FUNCTION;
+	save_csv_task& operator=(save_csv_task const&) GENOME_DELETE_FUNCTION;
+	stringtable const&                                   m_stb;
+	std::vector<key_list> const&                         m_ids;
+	std::vector<std::vector<name_arena::handle> > const& m_names;
+	wide_string const&                                   m_head;
+	enum { done_none, done_written, done_unchanged };
+	std::vector<u8>                                      m_done;  // per index (no locking)
+};
+
 void
 stringtable::save_csv(void)
 {
@@ -930,33 +2536,33 @@ stringtable::save_csv(void)
 			to_byte_string(std::string("default")));
 	}
 
-	std::vector<std::size_t> id_src;
-	std::vector<wide_string> id_str;
-	std::vector<string_hash> id_key;
-	for (name_map::const_iterator i = m_ids.begin(); i != m_ids.end(); ++i) {
+	// bucket the ids per source in one pass (in key_compare order)
+	key_list const& ids(get_id_keys());
+	std::vector<key_list> src_ids(m_src.size());
+	std::vector<std::vector<name_arena::handle> > src_names(m_src.size());
+	std::map<name_arena::handle, std::size_t> prefix_src;
+	for (key_list::const_iterator i = ids.begin(); i != ids.end(); ++i) {
 		std::size_t src = 0;  // first is the default
-		byte_string str;
-		byte_string const& name = i->second;
-		byte_string::size_type const pos = name.find_first_of(byte_code::colon);
-		if (pos != byte_string::npos) {
-			str.assign(name, pos + 1, byte_string::npos);
-			byte_string const p(name, 0, pos);
-			string_hash const h = hash_name(p);
-			for (src_list::const_iterator j = m_src.begin(); j != m_src.end(); ++j) {
-				if (j->get_prefix_hash() == h) {
-					src = static_cast<std::size_t>(j - m_src.begin());
-					break;
+		id_name const& name = m_ids.find(*i)->second;
+		if (name.prefix) {
+			std::map<name_arena::handle, std::size_t>::const_iterator pos = prefix_src.find(name.prefix);
+			if (pos != prefix_src.end()) {
+				src = pos->second;
+			} else {
+				byte_string p(m_names.c_str(name.prefix));
+				p.erase(p.size() - 1);  // colon
+				string_hash const h = hash_name(p);
+				for (src_list::const_iterator j = m_src.begin(); j != m_src.end(); ++j) {
+					if (j->get_prefix_hash() == h) {
+						src = static_cast<std::size_t>(j - m_src.begin());
+						break;
+					}
 				}
+				prefix_src.insert(std::make_pair(name.prefix, src));
 			}
-		} else {
-			str.assign(name);
-		}
-		if (str.empty()) {
-			str = hash_to_string(i->first);
 		}
-		id_src.push_back(src);
-		id_str.push_back(to_wide_string(str));
-		id_key.push_back(i->first);
+		src_ids[src].push_back(*i);
+		src_names[src].push_back(name.id);
 	}
 
 	wide_string head(to_wide_string(std::wstring(L"ID")));
@@ -965,67 +2571,50 @@ stringtable::save_csv(void)
 		head += to_wide_string(i->name);
 	}
 
-	for (std::size_t i = 0; i < m_src.size(); ++i) {
-		std::vector<std::size_t> src_idx;
-		for (std::size_t j = 0; j < id_src.size(); ++j) {
-			if (id_src[j] == i) {
-				src_idx.push_back(j);
-			}
-		}
-		std::string csv(to_string(m_src[i].get_csv()));
-		std::wcout << L"[" << to_wstring(csv) << L"]" << std::endl;
-		filesystem::ensure_directories(csv.c_str());
-		u16otfstream oft(csv.c_str(), tstream::encoding_utf8, tstream::newline_unix);
-		if (!oft.putline(head)) {
-			throw std::runtime_error("failed to write csv header");
-		}
-		for (std::vector<std::size_t>::const_iterator j = src_idx.begin(); j != src_idx.end(); ++j) {
-			wide_string line = id_str[*j];
-			for (col_list::const_iterator k = m_col.begin(); k != m_col.end(); ++k) {
-				line.push_back(0x007C);  // '|'
-				wide_string text;
-				text_map::const_iterator row = k->rows.find(id_key[*j]);
-				if (row != k->rows.end()) {
-					text.assign(row->second);
-				}
-				for (wide_string::const_iterator m = text.begin(); m != text.end(); ++m) {
-					switch (*m) {
-					case 0x0000:  // '\0'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x0030);  // '0'
-						break;
-					case 0x000A:  // '\n'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x006E);  // 'n'
-						break;
-					case 0x000D:  // '\r'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x0072);  // 'r'
-						break;
-					case 0x0040:  // '@'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x0061);  // 'a'
-						break;
-					case 0x005C:  // '\\'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x005C);  // '\\'
-						break;
-					case 0x007C:  // '|'
-						line.push_back(0x005C);  // '\\'
-						line.push_back(0x0076);  // 'v'
-						break;
-					default:
-						line.push_back(*m);
-						break;
-					}
-				}
-			}
-			if (!oft.putline(line)) {
-				throw std::runtime_error("failed to write csv line");
-			}
+	// one file per source on the worker threads (m_ids/m_col are read-only),
+	// the console output is printed in source order when all are finished
+	save_csv_task task(*this, src_ids, src_names, head);
+	try {
+		parallel_for(task, m_src.size());
+	} catch (...) {
+		task.print();
+		throw;
+	}
+	task.print();
+}
+
+bool
+stringtable::save_csv_src(std::string const& csv, key_list const& keys, std::vector<name_arena::handle> const& names, wide_string const& head) const
+{
+	profile::scope prof("save_csv", csv);
+	filesystem::ensure_directories(csv.c_str());
+	csv_writer out(csv.c_str(), m_skip_unchanged);
+	if (!out || !out.put_raw(head) || !out.put_newline()) {
+		throw std::runtime_error("failed to write csv header");
+	}
+	// one cursor per column, advanced in the order of the source ids
+	std::vector<row_cursor> rows;
+	rows.reserve(m_col.size());
+	for (col_list::const_iterator k = m_col.begin(); k != m_col.end(); ++k) {
+		rows.push_back(row_cursor(keys, *k));
+	}
+	for (std::size_t j = 0; j < keys.size(); ++j) {
+		name_arena::handle const name = names[j];
+		bool ok = out.put_raw(to_wide_string(name ? byte_string(m_names.c_str(name)) : hash_to_string(keys[j])));
+		for (std::vector<row_cursor>::iterator k = rows.begin(); k != rows.end(); ++k) {
+			ok = ok && out.put_separator() && out.put_text(k->text().begin(), k->text().end());
+			k->next();
 		}
-		std::wcout << std::endl;
+		if (!ok || !out.put_newline()) {
+			throw std::runtime_error("failed to write csv line");
+		}
+	}
+	if (!out.close()) {
+		throw std::runtime_error("failed to write csv line");
 	}
+	prof.add_items(keys.size());
+	prof.add_bytes_out(out.size());
+	return (out.written());
 }
 
 stringtable::text_list
@@ -1081,147 +2670,531 @@ stringtable::split_csv_line(wide_string const& csv_line)
 }
 
 void
-stringtable::read_csv(bool utf)
+stringtable::parse_csv(char const* csv_path, bool utf, csv_table& tab)
 {
 	string_hash const id_col_name_hash = hash_name(to_byte_string(std::wstring(L"ID")));
 
-	for (src_list::iterator psrc = m_src.begin(); psrc != m_src.end(); ++psrc) {
-		source& src = *psrc;
-		std::string const fname(to_string(src.get_csv()));
-		std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
-		{
-			filetime ftime(fname.c_str());
-			if (!ftime.valid()) {
-				throw std::runtime_error("failed to get csv time");
+	tab.cols.clear();
+	tab.recs.clear();
+	u16itfstream ift(csv_path, tstream::encoding_unknown, utf);
+	tab.ansi = (tstream::encoding_genome == ift.getenc());
+	if (tab.ansi) {
+		warn_csv_ansi();
+	}
+	wide_string csv_rec;
+	if (!ift.getline(csv_rec)) {
+		throw std::runtime_error("failed to read csv head");
+	}
+	{
+		text_list csv_fld = split_csv_line(csv_rec);
+		for (text_list::const_iterator pfld = ++csv_fld.begin(); pfld != csv_fld.end(); ++pfld) {
+			byte_string col_name;
+			if (!string_convert(*pfld, col_name) || col_name.empty() || (id_col_name_hash == hash_name(col_name))) {
+				throw std::invalid_argument("invalid csv column name");
 			}
-			src.set_modified(ftime);
-			std::wcout << L"modtime=" << to_wstring(ftime) << std::endl;
+			tab.cols.push_back(col_name);
+		}
+	}
+
+	u32 csv_lno = 1;
+	while (!ift.eof() && ift.getline(csv_rec)) {
+		++csv_lno;
+		if (csv_rec.empty()) {
+			continue;
+		}
+		text_list csv_fld = split_csv_line(csv_rec);
+		if (csv_fld.size() - 1 > tab.cols.size()) {
+			throw std::invalid_argument("too many csv fields in line " + to_string(csv_lno));
+		}
+		csv_record& rec = *tab.recs.insert(tab.recs.end(), csv_record());
+		rec.line = csv_lno;
+		if (!string_convert(csv_fld.front(), rec.id) || rec.id.empty()) {
+			throw std::invalid_argument("invalid csv id in line " + to_string(csv_lno));
 		}
+		rec.text.assign(++csv_fld.begin(), csv_fld.end());
+	}
+	if (!ift) {
+		throw std::runtime_error("failed to read csv line " + to_string(csv_lno));
+	}
+}
 
-		u16itfstream ift(fname.c_str(), tstream::encoding_unknown, utf);
-		if (tstream::encoding_genome == ift.getenc()) {
-			std::wclog << L";warn: CSV with Windows-1252 encoding (UTF-8 without BOM?)" << std::endl;
+void
+stringtable::apply_csv(source const& src, csv_table const& tab)
+{
+	std::vector<std::size_t> col_idx;
+	for (std::vector<byte_string>::const_iterator pcol = tab.cols.begin(); pcol != tab.cols.end(); ++pcol) {
+		std::size_t idx = add_col(*pcol);
+		for (std::vector<std::size_t>::const_iterator pidx = col_idx.begin(); pidx != col_idx.end(); ++pidx) {
+			if (*pidx == idx) {
+				throw std::invalid_argument("duplicate csv column name");
+			}
 		}
-		wide_string csv_rec;
-		if (!ift.getline(csv_rec)) {
-			throw std::runtime_error("failed to read csv head");
+		col_idx.push_back(idx);
+	}
+
+	// the prefix is interned once per source (unless it would be split by intern_name)
+	byte_string const& prefix = src.get_prefix();
+	bool const plain_prefix = !prefix.empty() && (prefix.find_first_of(byte_code::colon) == byte_string::npos);
+	name_arena::handle const prefix_name = plain_prefix ? m_names.intern(prefix + byte_code::colon) : 0;
+
+	u32 rec_cnt = 0;
+	u32 no_name = 0;
+	m_ids.reserve(m_ids.size() + tab.recs.size());
+	for (std::vector<csv_record>::const_iterator prec = tab.recs.begin(); prec != tab.recs.end(); ++prec) {
+		id_name name = id_name();
+		string_hash id_hash;
+		if (string_to_hash(prec->id, id_hash)) {
+			//TODO: idhash parsing should be optional
+			++no_name;
+		} else {
+			id_hash = hash_name(prec->id);
+			if (plain_prefix) {
+				name.prefix = prefix_name;
+				name.id = m_names.intern(prec->id);
+			} else if (!prefix.empty()) {
+				byte_string full(prefix);
+				full.push_back(byte_code::colon);
+				full.append(prec->id);
+				name = intern_name(full);
+			} else {
+				name = intern_name(prec->id);
+			}
 		}
-		std::vector<std::size_t> col_idx;
 		{
-			text_list csv_fld = split_csv_line(csv_rec);
-			for (text_list::const_iterator pfld = ++csv_fld.begin(); pfld != csv_fld.end(); ++pfld) {
-				byte_string col_name;
-				if (!string_convert(*pfld, col_name) || col_name.empty() || (id_col_name_hash == hash_name(col_name))) {
-					throw std::invalid_argument("invalid csv column name");
+			std::pair<name_map::iterator, bool> id = m_ids.insert(std::make_pair(id_hash, name));
+			if (!id.second) {
+				std::string info;
+				info.assign("hash conflict in csv line ");
+				info.append(to_string(prec->line));
+				info.append(" (");
+				info.append(to_string(id_hash));
+				info.append("|");
+				info.append(to_string(make_name(name)));
+				info.append("|");
+				info.append(to_string(make_name(id.first->second)));
+				info.append(")");
+				throw std::invalid_argument(info);
+			}
+		}
+		std::vector<std::size_t>::const_iterator pidx = col_idx.begin();
+		for (text_list::const_iterator pfld = prec->text.begin(); pfld != prec->text.end(); ++pfld, ++pidx) {
+			wide_string const& id_text = *pfld;
+			if (!id_text.empty()) {
+				m_col[*pidx].set(id_hash, id_text);
+			}
+		}
+		++rec_cnt;
+	}
+	// the rows stay pending until read_csv commits all sources at once
+	std::wcout << L"records=" << to_wstring(rec_cnt) << std::endl;
+	std::wcout << L"unnamed=" << to_wstring(no_name) << std::endl;
+}
+
+void
+stringtable::read_csv_cache(char const* cache_path, csv_cache& cache)
+{
+	cache.clear();
+	u64 size;
+	if (!filesystem::get_file_size(cache_path, size)) {
+		return;  // no cache yet
+	}
+	try {
+		// parsed in memory (many small fields, no virtual archive calls)
+		std::vector<u8> data;
+		if (!filesystem::read_file(cache_path, data)) {
+			throw std::runtime_error("failed to read csv cache file");
+		}
+		iarchive_span<archive::little_endian> ifa(data);
+		u32 magic = 0;
+		u32 count = 0;
+		if (!(ifa >> magic >> count) || (magic != csv_cache_magic)) {
+			throw std::invalid_argument("invalid csv cache signature");
+		}
+		for (u32 i = 0; i < count; ++i) {
+			csv_cache_entry& ent = *cache.insert(cache.end(), csv_cache_entry());
+			u8 utf = 0;
+			u8 ansi = 0;
+			u32 col_count = 0;
+			u32 rec_count = 0;
+			if (!(ifa >> ent.csv_path >> ent.modified >> ent.size >> utf >> ansi >> col_count)) {
+				throw std::invalid_argument("invalid csv cache entry");
+			}
+			ent.utf = (utf != 0);
+			ent.table.ansi = (ansi != 0);
+			ent.table.cols.resize(col_count);
+			for (u32 j = 0; j < col_count; ++j) {
+				ifa >> ent.table.cols[j];
+			}
+			if (!(ifa >> rec_count)) {
+				throw std::invalid_argument("invalid csv cache entry");
+			}
+			ent.table.recs.resize(rec_count);
+			for (u32 j = 0; ifa && (j < rec_count); ++j) {
+				csv_record& rec = ent.table.recs[j];
+				u32 fld_count = 0;
+				ifa >> rec.line >> rec.id >> fld_count;
+				if (fld_count > col_count) {
+					throw std::invalid_argument("invalid csv cache record");
 				}
-				std::size_t idx = add_col(col_name);
-				for (std::vector<std::size_t>::const_iterator pidx = col_idx.begin(); pidx != col_idx.end(); ++pidx) {
-					if (*pidx == idx) {
-						throw std::invalid_argument("duplicate csv column name");
-					}
+				rec.text.resize(fld_count);
+				for (u32 k = 0; ifa && (k < fld_count); ++k) {
+					read_wide_string(ifa, rec.text[k]);
 				}
-				col_idx.push_back(idx);
+			}
+			if (!ifa) {
+				throw std::invalid_argument("truncated csv cache entry");
 			}
 		}
+	} catch (std::exception& e) {
+		std::wclog << L";warn: ignoring csv cache (" << to_wstring(std::string(e.what())) << L")" << std::endl;
+		cache.clear();
+	}
+}
 
-		u32 csv_lno = 1;
-		u32 rec_cnt = 0;
-		u32 no_name = 0;
-		while (!ift.eof() && ift.getline(csv_rec)) {
-			++csv_lno;
-			if (csv_rec.empty()) {
-				continue;
-			}
-			text_list csv_fld = split_csv_line(csv_rec);
-			if (csv_fld.size() - 1 > col_idx.size()) {
-				throw std::invalid_argument("too many csv fields in line " + to_string(csv_lno));
+void
+stringtable::save_csv_cache(char const* cache_path, csv_cache const& cache)
+{
+	std::vector<u8> data;
+	oarchive_buffer<archive::little_endian> ofa(data);
+	ofa << u32(csv_cache_magic) << u32(cache.size());
+	for (csv_cache::const_iterator pent = cache.begin(); pent != cache.end(); ++pent) {
+		csv_table const& tab = pent->table;
+		ofa << pent->csv_path << pent->modified << pent->size << u8(pent->utf ? 1 : 0) << u8(tab.ansi ? 1 : 0);
+		ofa << u32(tab.cols.size());
+		for (std::vector<byte_string>::const_iterator pcol = tab.cols.begin(); pcol != tab.cols.end(); ++pcol) {
+			ofa << *pcol;
+		}
+		ofa << u32(tab.recs.size());
+		for (std::vector<csv_record>::const_iterator prec = tab.recs.begin(); prec != tab.recs.end(); ++prec) {
+			ofa << prec->line << prec->id << u32(prec->text.size());
+			for (text_list::const_iterator pfld = prec->text.begin(); pfld != prec->text.end(); ++pfld) {
+				write_wide_string(ofa, *pfld);
 			}
+		}
+	}
+	filesystem::ensure_directories(cache_path);
+	bool written;
+	if (!ofa || !filesystem::update_file(cache_path, reinterpret_cast<char const*>(&data[0]), data.size(), written)) {
+		throw std::runtime_error("failed to write csv cache file");
+	}
+}
+
+void
+stringtable::read_csv(bool utf, char const* cache_path)
+{
+	bool const use_cache = cache_path && *cache_path;
+	csv_cache old_cache;
+	csv_cache new_cache;
+	if (use_cache) {
+		std::wcout << L"[" << to_wstring(std::string(cache_path)) << L"]" << std::endl;
+		{
+			profile::scope prof("read_csv_cache", cache_path);
+			read_csv_cache(cache_path, old_cache);
+			prof.add_items(old_cache.size());
+		}
+		std::wcout << L"cached=" << to_wstring(old_cache.size()) << std::endl;
+		std::wcout << std::endl;
+	}
+	// exact (case-sensitive) path lookup of the cached entries
+	std::map<byte_string, csv_cache::size_type> old_index;
+	for (csv_cache::size_type i = 0; i < old_cache.size(); ++i) {
+		old_index.insert(std::make_pair(old_cache[i].csv_path, i));
+	}
+
+	for (src_list::iterator psrc = m_src.begin(); psrc != m_src.end(); ++psrc) {
+		source& src = *psrc;
+		std::string const fname(to_string(src.get_csv()));
+		std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+		profile::scope prof("read_csv", fname);
+		filetime ftime(fname.c_str());
+		if (!ftime.valid()) {
+			throw std::runtime_error("failed to get csv time");
+		}
+		src.set_modified(ftime);
+		std::wcout << L"modtime=" << to_wstring(ftime) << std::endl;
 
-			text_list::const_iterator pfld = csv_fld.begin();
-			byte_string id_name;
-			if (!string_convert(*pfld, id_name) || id_name.empty()) {
-				throw std::invalid_argument("invalid csv id in line " + to_string(csv_lno));
+		if (!use_cache) {
+			csv_table tab;
+			parse_csv(fname.c_str(), utf, tab);
+			apply_csv(src, tab);
+			prof.add_items(tab.recs.size());
+			u64 fsize = 0;
+			if (filesystem::get_file_size(fname.c_str(), fsize)) {
+				prof.add_bytes_in(fsize);
 			}
-			string_hash id_hash;
-			if (string_to_hash(id_name, id_hash)) {
-				//TODO: idhash parsing should be optional
-				id_name.erase();
-				++no_name;
-			} else {
-				id_hash = hash_name(id_name);
-				byte_string const& prefix = src.get_prefix();
-				if (!prefix.empty()) {
-					id_name.insert(0, 1, byte_code::colon);
-					id_name.insert(0, prefix);
+		} else {
+			csv_cache_entry& ent = *new_cache.insert(new_cache.end(), csv_cache_entry());
+			ent.csv_path = src.get_csv();
+			ent.modified = ftime;
+			ent.utf = utf;
+			if (!filesystem::get_file_size(fname.c_str(), ent.size)) {
+				throw std::runtime_error("failed to get csv size");
+			}
+			bool reused = false;
+			std::map<byte_string, csv_cache::size_type>::const_iterator const iold = old_index.find(ent.csv_path);
+			if (iold != old_index.end()) {
+				csv_cache_entry& old = old_cache[iold->second];
+				if ((old.modified.ticks() == ent.modified.ticks()) &&
+					(old.size == ent.size) && (old.utf == ent.utf)) {
+					ent.table.cols.swap(old.table.cols);
+					ent.table.recs.swap(old.table.recs);
+					ent.table.ansi = old.table.ansi;
+					reused = true;
+					if (ent.table.ansi) {
+						warn_csv_ansi();
+					}
 				}
 			}
-			{
-				std::pair<name_map::iterator, bool> id = m_ids.insert(std::make_pair(id_hash, id_name));
-				if (!id.second) {
-					std::string info;
-					info.assign("hash conflict in csv line ");
-					info.append(to_string(csv_lno));
-					info.append(" (");
-					info.append(to_string(id_hash));
-					info.append("|");
-					info.append(to_string(id_name));
-					info.append("|");
-					info.append(to_string(id.first->second));
-					info.append(")");
-					throw std::invalid_argument(info);
+			if (!reused) {
+				parse_csv(fname.c_str(), utf, ent.table);
+				prof.add_bytes_in(ent.size);
+			}
+			std::wcout << L"reused=" << to_wstring(reused ? 1 : 0) << std::endl;
+			apply_csv(src, ent.table);
+			prof.add_items(ent.table.recs.size());
+		}
+		std::wcout << std::endl;
+	}
+	// one merge per column (instead of one per source and column)
+	for (col_list::iterator pcol = m_col.begin(); pcol != m_col.end(); ++pcol) {
+		pcol->commit();
+	}
+
+	if (use_cache) {
+		profile::scope prof("save_csv_cache", cache_path);
+		save_csv_cache(cache_path, new_cache);
+		prof.add_items(new_cache.size());
+	}
+}
+
+void
+stringtable::save_map(char const* csv_path)
+{
+	std::string fname((csv_path && *csv_path) ? csv_path : "#G3:/lianzifu.csv");
+	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("save_map", fname);
+	csv_writer out(fname.c_str(), m_skip_unchanged);
+	if (!out) {
+		throw std::runtime_error("failed to create idname mapping file");
+	}
+	u32 rec_cnt = 0;
+	key_list const& ids(get_id_keys());
+	for (key_list::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+		id_name const& idn = m_ids.find(*id)->second;
+		if (!idn.empty()) {
+			byte_string const name(make_name(idn));
+			wide_string line = string_cast<byte_string, wide_string>(name);
+			line.push_back(0x007C);  // '|'
+			line.append(string_cast<byte_string, wide_string>(hash_to_string(*id)));
+			if (!out.put_raw(line) || !out.put_newline()) {
+				throw std::runtime_error("failed to write idname mapping line");
+			}
+			++rec_cnt;
+		}
+	}
+	if (!out.close()) {
+		throw std::runtime_error("failed to write idname mapping line");
+	}
+	prof.add_items(rec_cnt);
+	prof.add_bytes_out(out.size());
+	std::wcout << L"idnames=" << to_wstring(rec_cnt) << std::endl;
+	if (m_skip_unchanged) {
+		std::wcout << L"output=" << (out.written() ? L"written" : L"unchanged") << std::endl;
+	}
+	std::wcout << std::endl;
+}
+
+void
+stringtable::recover_ids(char const* csv_path, std::size_t max_length, char const* word_path)
+{
+	std::string fname((csv_path && *csv_path) ? csv_path : "#G3:/lianzifu-recovered.csv");
+	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	if (max_length > std::size_t(hash_recovery::max_brute_force_length)) {
+		throw std::invalid_argument("brute force length exceeds " + to_string(int(hash_recovery::max_brute_force_length)));
+	}
+	hash_recovery rec;
+	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
+		if (id->second.empty()) {
+			rec.add_target(id->first);
+		}
+	}
+	std::wcout << L"idhash.unknown=" << to_wstring(rec.target_count()) << std::endl;
+	if (0 == rec.target_count()) {
+		std::wcout << std::endl;
+		return;
+	}
+
+	// mine heads ("ACH_Kill_"), tails ("_DESC"), and words from the known ids
+	recovery_affix_map heads;
+	recovery_affix_map tails;
+	recovery_affix_map words;
+	{
+		std::set<name_arena::handle> known;
+		name_map const* const maps[2] = { &m_map, &m_ids };
+		for (std::size_t m = 0; m < 2; ++m) {
+			for (name_map::const_iterator i = maps[m]->begin(); i != maps[m]->end(); ++i) {
+				id_name const& idn = i->second;
+				if (idn.empty() || !known.insert(idn.id).second) {
+					continue;
+				}
+				byte_string const id(m_names.c_str(idn.id));
+				byte_string::size_type beg = 0;
+				for (byte_string::size_type pos = id.find(byte_code::low_line); pos != byte_string::npos; pos = id.find(byte_code::low_line, pos + 1)) {
+					if (pos > beg) {
+						add_recovery_affix(words, id.substr(beg, pos - beg), 0);
+					}
+					if (pos > 0) {
+						add_recovery_affix(heads, id.substr(0, pos + 1), idn.prefix);
+						add_recovery_affix(tails, id.substr(pos), 0);
+					}
+					beg = pos + 1;
+				}
+				if (beg < id.size()) {
+					add_recovery_affix(words, id.substr(beg), 0);
 				}
 			}
-			std::vector<std::size_t>::const_iterator pidx = col_idx.begin();
-			for (++pfld; pfld != csv_fld.end(); ++pfld, ++pidx) {
-				wide_string const& id_text = *pfld;
-				if (!id_text.empty()) {
-					column& col = m_col[*pidx];
-					std::pair<text_map::iterator, bool> row = col.rows.insert(std::make_pair(id_hash, id_text));
-					if (!row.second) {
-						//FIXME: this should never happen
-						row.first->second = id_text;
+		}
+	}
+	// the empty head has index 0 (without prefix)
+	std::vector<name_arena::handle> head_prefix(1, name_arena::handle(0));
+	{
+		std::vector<recovery_affix> const list(sort_recovery_affixes(heads, 2, 256));
+		for (std::size_t i = 0; i < list.size(); ++i) {
+			if (rec.add_head(list[i].str)) {
+				// use the most frequent prefix (save_csv selects the source)
+				name_arena::handle prefix = 0;
+				u32 count = 0;
+				for (std::map<u32, u32>::const_iterator p = list[i].prefixes.begin(); p != list[i].prefixes.end(); ++p) {
+					if (p->second > count) {
+						prefix = p->first;
+						count = p->second;
 					}
 				}
+				head_prefix.push_back(prefix);
+			}
+		}
+	}
+	{
+		std::vector<recovery_affix> const list(sort_recovery_affixes(tails, 2, 64));
+		for (std::size_t i = 0; i < list.size(); ++i) {
+			rec.add_tail(list[i].str);
+		}
+	}
+	{
+		std::vector<recovery_affix> const list(sort_recovery_affixes(words, 1, std::size_t(-1)));
+		for (std::size_t i = 0; i < list.size(); ++i) {
+			rec.add_word(list[i].str);
+		}
+	}
+	if (word_path && *word_path) {
+		u16itfstream ift(word_path, tstream::encoding_utf8);
+		if (!ift) {
+			throw std::runtime_error("failed to open word list file");
+		}
+		u16itfstream::string_type str;
+		while (!ift.eof() && ift.getline(str)) {
+			byte_string word;
+			if (!str.empty() && string_convert(str, word)) {
+				rec.add_word(word);
 			}
-			++rec_cnt;
 		}
 		if (!ift) {
-			throw std::runtime_error("failed to read csv line " + to_string(csv_lno));
+			throw std::runtime_error("failed to read word list file");
 		}
-		std::wcout << L"records=" << to_wstring(rec_cnt) << std::endl;
-		std::wcout << L"unnamed=" << to_wstring(no_name) << std::endl;
-		std::wcout << std::endl;
 	}
-}
+	std::wcout << L"recover.heads=" << to_wstring(rec.head_count()) << std::endl;
+	std::wcout << L"recover.tails=" << to_wstring(rec.tail_count()) << std::endl;
+	std::wcout << L"recover.words=" << to_wstring(rec.word_count()) << std::endl;
 
-void
-stringtable::save_map(char const* csv_path)
-{
-	std::string fname((csv_path && *csv_path) ? csv_path : "#G3:/lianzifu.csv");
-	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
-	u16otfstream oft(fname.c_str(), tstream::encoding_utf8, tstream::newline_unix);
-	if (!oft) {
-		throw std::runtime_error("failed to create idname mapping file");
-	}
+	// dictionary (all heads/tails), brute force (frequent heads/tails only)
+	hash_recovery::match_list matches;
+	u64 const dict_cnt = rec.run_dictionary(matches);
+	std::wcout << L"recover.dictionary=" << to_wstring(dict_cnt) << std::endl;
+	u64 const brute_cnt = rec.run_brute_force(matches, max_length, hash_recovery::brute_force_heads, hash_recovery::brute_force_tails);
+	std::wcout << L"recover.brute_force=" << to_wstring(brute_cnt) << std::endl;
+
+	// rendered in memory, the previous file is only replaced when complete
+	csv_writer out(fname.c_str(), true);
 	u32 rec_cnt = 0;
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		byte_string const& name = id->second;
-		if (!name.empty()) {
-			u16otfstream::string_type line = string_cast<byte_string, u16otfstream::string_type>(name);
-			line.push_back(0x007C);  // '|'
-			line.append(string_cast<byte_string, u16otfstream::string_type>(hash_to_string(id->first)));
-			if (!oft.putline(line)) {
-				throw std::runtime_error("failed to write idname mapping line");
-			}
-			++rec_cnt;
+	std::sort(matches.begin(), matches.end(), recovery_match_order());
+	for (std::size_t i = 0; i < matches.size();) {
+		hash_recovery::match const& m = matches[i];
+		std::size_t n = i + 1;
+		while ((n < matches.size()) && (matches[n].hash == m.hash)) {
+			++n;
+		}
+		byte_string name(m_names.c_str(head_prefix[m.head]));
+		name.append(m.name);
+		// different head/word/tail splits can build the same name
+		std::set<byte_string> names;
+		for (std::size_t j = i; j < n; ++j) {
+			names.insert(matches[j].name);
+		}
+		if (names.size() > 1) {
+			std::wclog << L";warn: [recover] ambiguous match " << to_wstring(name) << L" (" << to_wstring(names.size()) << L" candidates for " << to_wstring(hash_to_string(m.hash)) << L")" << std::endl;
+		} else if (hash_recovery::match_brute_force == m.source) {
+			std::wclog << L";warn: [recover] unverified brute force match " << to_wstring(name) << std::endl;
+		}
+		wide_string line = string_cast<byte_string, wide_string>(name);
+		line.push_back(0x007C);  // '|'
+		line.append(string_cast<byte_string, wide_string>(hash_to_string(m.hash)));
+		if (!out.put_raw(line) || !out.put_newline()) {
+			throw std::runtime_error("failed to write idname mapping line");
 		}
+		// use the names like read_map for the following commands
+		id_name const idn(intern_name(name));
+		m_map.insert(std::make_pair(m.hash, idn));
+		m_ids.find(m.hash)->second = idn;
+		++rec_cnt;
+		i = n;
+	}
+	if (!out.close()) {
+		throw std::runtime_error("failed to write idname mapping file");
 	}
 	std::wcout << L"idnames=" << to_wstring(rec_cnt) << std::endl;
+	if (m_skip_unchanged) {
+		std::wcout << L"output=" << (out.written() ? L"written" : L"unchanged") << std::endl;
+	}
 	std::wcout << std::endl;
 }
 
+stringtable::id_name
+stringtable::intern_name(byte_string const& name)
+{
+	// split after the first colon (save_csv selects the source by this prefix)
+	id_name idn;
+	byte_string::size_type const pos = name.find_first_of(byte_code::colon);
+	if (pos != byte_string::npos) {
+		idn.prefix = m_names.intern(name.substr(0, pos + 1));
+		idn.id = m_names.intern(name.substr(pos + 1));
+	} else {
+		idn.prefix = 0;
+		idn.id = m_names.intern(name);
+	}
+	return (idn);
+}
+
+byte_string
+stringtable::make_name(id_name const& name) const
+{
+	byte_string str(m_names.c_str(name.prefix));
+	str.append(m_names.c_str(name.id));
+	return (str);
+}
+
+stringtable::key_list const&
+stringtable::get_id_keys(void) const
+{
+	// ids are only added (or all cleared), so a size change invalidates the keys
+	if (m_id_keys.size() != m_ids.size()) {
+		// key_compare (std::greater) is the descending order
+		m_ids.sorted_keys(m_id_keys, true);
+	}
+	return (m_id_keys);
+}
+
 void
-stringtable::pack_col_none(column const& col, bin_table& tab) const
+stringtable::pack_col_none(column const& col, key_list const& ids, bin_table& tab) const
 {
 	// symbol index = UTF-16 code, full code table, no symbol links
 	tab.sym_tab.reserve(1 << 16);
@@ -1229,21 +3202,16 @@ stringtable::pack_col_none(column const& col, bin_table& tab) const
 	for (u32 chr = 1; chr <= u16(-1); ++chr) {
 		tab.add_char_symbol(u16(chr));
 	}
-	tab.seq_tab.reserve(col.rows.size() * 64);
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (col.rows.end() == row) {
-			tab.add_empty_string();
-			continue;
-		}
-		wide_string const& str = row->second;
+	tab.seq_tab.reserve(col.size() * 64);
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
 		if (str.empty()) {
 			tab.add_empty_string();
 			continue;
 		}
 
 		tab.add_new_string();
-		for (wide_string::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
 			u16 const sym = u16(*chr);
 			tab.add_sequence(sym);
 		}
@@ -1252,7 +3220,7 @@ stringtable::pack_col_none(column const& col, bin_table& tab) const
 }
 
 void
-stringtable::pack_col_fast(column const& col, bin_table& tab) const
+stringtable::pack_col_fast(column const& col, key_list const& ids, bin_table& tab) const
 {
 	typedef std::map<wide_char, u16> chr2sym_map;
 
@@ -1261,22 +3229,17 @@ stringtable::pack_col_fast(column const& col, bin_table& tab) const
 	chr2sym.insert(std::make_pair(wide_char(0), u16(0)));
 
 	// one symbol per UTF-16 code, no symbol links
-	tab.seq_tab.reserve(col.rows.size() * 64);
+	tab.seq_tab.reserve(col.size() * 64);
 	tab.sym_tab.reserve(128);
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (col.rows.end() == row) {
-			tab.add_empty_string();
-			continue;
-		}
-		wide_string const& str = row->second;
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
 		if (str.empty()) {
 			tab.add_empty_string();
 			continue;
 		}
 
 		tab.add_new_string();
-		for (wide_string::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
 			chr2sym_map::iterator sym = chr2sym.find(*chr);
 			if (chr2sym.end() == sym) {
 				sym = chr2sym.insert(std::make_pair(*chr, tab.get_next_symbol())).first;
@@ -1289,7 +3252,7 @@ stringtable::pack_col_fast(column const& col, bin_table& tab) const
 }
 
 void
-stringtable::pack_col_lzpb(column const& col, bin_table& tab, bool ext) const
+stringtable::pack_col_lzpb(column const& col, key_list const& ids, bin_table& tab, bool ext) const
 {
 	typedef std::map<u32, u16> key2sym_map;
 
@@ -1299,30 +3262,22 @@ stringtable::pack_col_lzpb(column const& col, bin_table& tab, bool ext) const
 
 	// ensure that all used UTF-16 codes are present as unlinked symbols
 	tab.sym_tab.reserve(1 << 16);
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (row != col.rows.end()) {
-			wide_string const& str = row->second;
-			for (wide_string::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
-				u32 const key = bin_table::make_char_symbol(*chr);
-				if (key2sym.end() == key2sym.find(key)) {
-					key2sym.insert(std::make_pair(key, tab.get_next_symbol()));
-					tab.add_symbol(key);
-				}
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+			u32 const key = bin_table::make_char_symbol(*chr);
+			if (key2sym.end() == key2sym.find(key)) {
+				key2sym.insert(std::make_pair(key, tab.get_next_symbol()));
+				tab.add_symbol(key);
 			}
 		}
 	}
 
 	// add one-growing sequences until the symbol table is full
-	tab.seq_tab.reserve(col.rows.size() * 16);
+	tab.seq_tab.reserve(col.size() * 16);
 	std::vector<u16> str_seq;
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (col.rows.end() == row) {
-			tab.add_empty_string();
-			continue;
-		}
-		wide_string const& str = row->second;
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
 		if (str.empty()) {
 			tab.add_empty_string();
 			continue;
@@ -1332,7 +3287,7 @@ stringtable::pack_col_lzpb(column const& col, bin_table& tab, bool ext) const
 		bool str_ext = ext;
 		u16 seq_sym = 0;
 		std::size_t seq_len = 0;
-		for (wide_string::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
 			u32 const key = bin_table::make_link_symbol(*chr, seq_sym);
 			key2sym_map::iterator sym = key2sym.find(key);
 			if (sym != key2sym.end()) {
@@ -1375,27 +3330,28 @@ stringtable::pack_col_lzpb(column const& col, bin_table& tab, bool ext) const
 }
 
 void
-stringtable::pack_col_tree_char(column const& col, bin_table& tab, bool ext) const {
+stringtable::pack_col_tree_char(column const& col, key_list const& ids, bin_table& tab, bool ext) const {
 	typedef nicode::suffix_tree<wide_char, nicode::suffix_tree_traits<wide_char, wide_string, stb_allocator, u32> > tree_type;
 	typedef std::pair<u16, u16> symbol_info;  // first: last symbol index, second: current symbol length (in table)
 	typedef std::pair<std::size_t, tree_type::position> char_info;  // first: node index, second: sequence length
 
 	tab.sym_tab.reserve(1 << 16);
-	tab.seq_tab.reserve(col.rows.size() * 16);
+	tab.seq_tab.reserve(col.size() * 16);
 
 	// build generalized suffix tree from all non-empty strings
 	tree_type tree;
-	tree.reserve(col.rows.size() * 64, col.rows.size() * 96);
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (row != col.rows.end()) {
-			wide_string const& str = row->second;
+	tree.reserve(col.size() * 64, col.size() * 96);
+	{
+		profile::scope prof("suffix_tree", to_string(col.name));
+		for (row_cursor row(ids, col); row.valid(); row.next()) {
+			text_ref const& str = row.text();
 			if (!str.empty()) {
-				tree.append(str);
+				tree.append(str.str());
 			}
 		}
+		tree.build();
+		prof.add_items(tree.size());
 	}
-	tree.build();
 
 	// calc weight (suffix frequency) of all non-leaf nodes
 	std::vector<tree_type::position> node_weight(tree.size(), 0);
@@ -1441,13 +3397,8 @@ stringtable::pack_col_tree_char(column const& col, bin_table& tab, bool ext) con
 	// iterate over all strings and add the symbols/sequences
 	std::vector<char_info> char_node;
 	std::vector<u16> str_seq;
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (col.rows.end() == row) {
-			tab.add_empty_string();
-			continue;
-		}
-		wide_string const& str = row->second;
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
 		if (str.empty()) {
 			tab.add_empty_string();
 			continue;
@@ -1455,12 +3406,12 @@ stringtable::pack_col_tree_char(column const& col, bin_table& tab, bool ext) con
 
 		// find suffix node indices and sequence length for every character position
 		char_node.clear();
-		char_node.reserve(str.length());
+		char_node.reserve(str.size());
 		{
 			tree_type::node const* prev = &tree.root();
-			for (wide_string::const_iterator pos = str.begin(); pos != str.end(); ++pos) {
+			for (text_ref::const_iterator pos = str.begin(); pos != str.end(); ++pos) {
 				tree_type::position length;
-				wide_string::const_iterator chr = pos;
+				text_ref::const_iterator chr = pos;
 				tree_type::node const* node = prev->link();
 				if (node && node->parent()) {
 					// non-root link found (previous suffix without the first character)
@@ -1664,7 +3615,7 @@ stringtable::pack_col_tree_char(column const& col, bin_table& tab, bool ext) con
 }
 
 void
-stringtable::pack_col_tree_node(column const& col, bin_table& tab, bool ext) const
+stringtable::pack_col_tree_node(column const& col, key_list const& ids, bin_table& tab, bool ext) const
 {
 	typedef std::map<u32, u16> key2sym_map;
 
@@ -1675,15 +3626,18 @@ stringtable::pack_col_tree_node(column const& col, bin_table& tab, bool ext) con
 		typedef nicode::suffix_tree<wide_char, nicode::suffix_tree_traits<wide_char, wide_string, stb_allocator, u32> > tree_type;
 
 		tree_type tree;
-		tree.reserve(col.rows.size() * 64, col.rows.size() * 96);
-		for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-			text_map::const_iterator row = col.rows.find(id->first);
-			if (row != col.rows.end()) {
-				wide_string const& str = row->second;
-				tree.append(str);
+		tree.reserve(col.size() * 64, col.size() * 96);
+		{
+			profile::scope prof("suffix_tree", to_string(col.name));
+			for (row_cursor row(ids, col); row.valid(); row.next()) {
+				text_ref const& str = row.text();
+				if (!str.empty()) {
+					tree.append(str.str());
+				}
 			}
+			tree.build();
+			prof.add_items(tree.size());
 		}
-		tree.build();
 
 		// ensure that all used UTF-16 codes are present as unlinked symbols
 		for (tree_type::node const* node = tree.root().front(); node; node = node->sibling()) {
@@ -1815,13 +3769,8 @@ stringtable::pack_col_tree_node(column const& col, bin_table& tab, bool ext) con
 	}
 
 	std::vector<u16> str_seq;
-	for (name_map::const_iterator id = m_ids.begin(); id != m_ids.end(); ++id) {
-		text_map::const_iterator row = col.rows.find(id->first);
-		if (col.rows.end() == row) {
-			tab.add_empty_string();
-			continue;
-		}
-		wide_string const& str = row->second;
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
 		if (str.empty()) {
 			tab.add_empty_string();
 			continue;
@@ -1830,7 +3779,7 @@ stringtable::pack_col_tree_node(column const& col, bin_table& tab, bool ext) con
 		str_seq.clear();
 		u16 seq_sym = 0;
 		std::size_t seq_len = 0;
-		for (wide_string::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
 			u32 const key = bin_table::make_link_symbol(*chr, seq_sym);
 			key2sym_map::iterator sym = key2sym.find(key);
 			if (sym != key2sym.end()) {
@@ -1856,43 +3805,44 @@ stringtable::pack_col_tree_node(column const& col, bin_table& tab, bool ext) con
 }
 
 void
-stringtable::pack_col(column const& col, bin_table& tab, compression comp) const
+stringtable::pack_col(column const& col, key_list const& ids, bin_table& tab, compression comp) const
 {
+	profile::scope prof("pack_col", pack_phase_name(col.name, comp));
 	tab.str_tab.clear();
-	tab.str_tab.reserve(m_ids.size());
+	tab.str_tab.reserve(ids.size());
 	tab.seq_tab.clear();
 	tab.sym_tab.clear();
 	// the symbol table cannot be empty and
 	// the symbol #0->0 is always added first
 	tab.add_symbol(u32(0));
-	if (col.rows.empty()) {
-		tab.str_tab.insert(tab.str_tab.end(), m_ids.size(), u32(-1));
+	if (col.empty()) {
+		tab.str_tab.insert(tab.str_tab.end(), ids.size(), u32(-1));
 	} else {
 		switch (comp) {
 		case compression_none:
-			pack_col_none(col, tab);
+			pack_col_none(col, ids, tab);
 			break;
 		case compression_fast:
-			pack_col_fast(col, tab);
+			pack_col_fast(col, ids, tab);
 			break;
 		case compression_lzpb:
-			pack_col_lzpb(col, tab, false);
+			pack_col_lzpb(col, ids, tab, false);
 			break;
 		case compression_lzex:
-			pack_col_lzpb(col, tab, true);
+			pack_col_lzpb(col, ids, tab, true);
 			break;
 		default:
 		case compression_tree:
 		case compression_best:
 			// fill symbol table with 'best' suffix nodes first (more strings)
-			pack_col_tree_node(col, tab, comp != compression_tree);
+			pack_col_tree_node(col, ids, tab, comp != compression_tree);
 			if (tab.seq_tab.size() < tab.sym_tab.size()) {
 				// add symbols while adding 'best' string nodes (less strings)
 				tab.str_tab.clear();
 				tab.seq_tab.clear();
 				tab.sym_tab.clear();
 				tab.add_symbol(u32(0));
-				pack_col_tree_char(col, tab, comp != compression_tree);
+				pack_col_tree_char(col, ids, tab, comp != compression_tree);
 			} else {
 				//TODO: remove unused symbols from the table
 			}
@@ -1903,10 +3853,258 @@ stringtable::pack_col(column const& col, bin_table& tab, compression comp) const
 	if (tab.get_next_sequence() % 2) {
 		tab.add_sequence_end();
 	}
+	prof.add_items(ids.size());
+	prof.add_bytes_in(col.pool().size() * sizeof(wide_char));
+	prof.add_bytes_out(tab.str_tab.size() * sizeof(u32) + tab.seq_tab.size() * sizeof(u16) + tab.sym_tab.size() * sizeof(u32));
+}
+
+u64
+stringtable::pack_col_hash(column const& col, key_list const& ids, compression comp) const
+{
+	// everything the packed table depends on: the id order, the strings,
+	// and the packer parameters (the revision catches format changes)
+	u64 hash = fnv1a64_update(fnv1a64_init, pack_cache_magic, 4);
+	hash = fnv1a64_update(hash, u32(comp), 4);
+	hash = fnv1a64_update(hash, u32(max_sequence_length), 4);
+	hash = fnv1a64_update(hash, u32(ids.size()), 4);
+	for (row_cursor row(ids, col); row.valid(); row.next()) {
+		text_ref const& str = row.text();
+		hash = fnv1a64_update(hash, row.key(), 4);
+		hash = fnv1a64_update(hash, u32(str.size()), 4);
+		for (text_ref::const_iterator chr = str.begin(); chr != str.end(); ++chr) {
+			hash = fnv1a64_update(hash, u16(*chr), 2);
+		}
+	}
+	return (hash);
+}
+
+std::string
+stringtable::pack_cache_file(u64 hash) const
+{
+	std::string fname(m_pack_cache);
+	if (!fname.empty() && (fname[fname.size() - 1] != '/') && (fname[fname.size() - 1] != '\\')) {
+		fname.append("/");
+	}
+	if (hash) {
+		fname.append(to_string(hash_to_string(string_hash(hash >> 32))));
+		fname.append(to_string(hash_to_string(string_hash(hash))));
+		fname.append(".pkc");
+	} else {
+		fname.append("index.pki");
+	}
+	return (fname);
 }
 
 void
-stringtable::save_bin(platform bin_plat, u8 bin_vers, char const* bin_path, compression comp, byte_string const& filter)
+stringtable::read_pack_cache_index(pack_cache_index& idx) const
+{
+	idx.session = 0;
+	idx.entries.clear();
+	std::string const fname(pack_cache_file(0));
+	u64 size;
+	if (filesystem::get_file_size(fname.c_str(), size)) {
+		try {
+			ifarchive ifa(fname.c_str());
+			u32 magic = 0;
+			u32 count = 0;
+			if (!(ifa >> magic >> idx.session >> count) || (magic != pack_index_magic)) {
+				throw std::invalid_argument("invalid pack cache index signature");
+			}
+			for (u32 i = 0; ifa && (i < count); ++i) {
+				u64 hash = 0;
+				pack_cache_entry ent;
+				if (ifa >> hash >> ent.size >> ent.used) {
+					idx.entries[hash] = ent;
+				}
+			}
+			if (!ifa) {
+				throw std::invalid_argument("truncated pack cache index");
+			}
+		} catch (std::exception& e) {
+			std::wclog << L";warn: rebuilding pack cache index (" << to_wstring(std::string(e.what())) << L")" << std::endl;
+			idx.session = 0;
+			idx.entries.clear();
+		}
+	}
+	// reconcile with the entry files, the size limit has to include the files
+	// of a missing/corrupt index (or of an interrupted run) to evict them
+	std::vector<std::string> names;
+	if (filesystem::list_files(m_pack_cache.c_str(), ".pkc", names)) {
+		std::map<u64, pack_cache_entry> entries;
+		for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name) {
+			byte_string hi;
+			byte_string lo;
+			string_hash h = 0;
+			string_hash l = 0;
+			if ((name->size() != 20) ||
+				!string_convert(name->substr(0, 8), hi) || !string_to_hash(hi, h) ||
+				!string_convert(name->substr(8, 8), lo) || !string_to_hash(lo, l)) {
+				continue;
+			}
+			u64 const hash = (u64(h) << 32) | u64(l);
+			pack_cache_entry ent;
+			ent.used = 0;  // unlisted entries are evicted first
+			if (!hash || !filesystem::get_file_size(pack_cache_file(hash).c_str(), ent.size)) {
+				continue;
+			}
+			std::map<u64, pack_cache_entry>::const_iterator const old = idx.entries.find(hash);
+			if (old != idx.entries.end()) {
+				ent.used = old->second.used;
+			}
+			entries[hash] = ent;
+		}
+		idx.entries.swap(entries);
+	}
+	++idx.session;
+}
+
+void
+stringtable::save_pack_cache_index(pack_cache_index& idx) const
+{
+	// evict the least recently used entries
+	u64 total = 0;
+	std::vector<std::pair<u32, u64> > lru;
+	lru.reserve(idx.entries.size());
+	for (std::map<u64, pack_cache_entry>::const_iterator ent = idx.entries.begin(); ent != idx.entries.end(); ++ent) {
+		total += ent->second.size;
+		lru.push_back(std::make_pair(ent->second.used, ent->first));
+	}
+	std::sort(lru.begin(), lru.end());
+	u32 evicted = 0;
+	for (std::vector<std::pair<u32, u64> >::const_iterator ent = lru.begin(); (ent != lru.end()) && (total > m_pack_cache_limit); ++ent) {
+		total -= idx.entries[ent->second].size;
+		idx.entries.erase(ent->second);
+		std::remove(filesystem::system_complete(pack_cache_file(ent->second).c_str()).c_str());
+		++evicted;
+	}
+	if (evicted) {
+		std::wcout << L"cache.evicted=" << to_wstring(evicted) << std::endl;
+	}
+	std::ostringstream data(std::ios_base::out | std::ios_base::binary);
+	{
+		osarchive osa(data, archive::little_endian);
+		osa << u32(pack_index_magic) << idx.session << u32(idx.entries.size());
+		for (std::map<u64, pack_cache_entry>::const_iterator ent = idx.entries.begin(); ent != idx.entries.end(); ++ent) {
+			osa << ent->first << ent->second.size << ent->second.used;
+		}
+	}
+	std::string const fname(pack_cache_file(0));
+	std::string const file(data.str());
+	bool written = false;
+	filesystem::ensure_directories(fname.c_str());
+	// written through a temporary file (an interrupted run keeps the old index)
+	if (!data || !filesystem::update_file(fname.c_str(), file.data(), file.size(), written)) {
+		// the cache is optional, the packed tables are already saved
+		std::wclog << L";warn: failed to write pack cache index" << std::endl;
+	}
+}
+
+bool
+stringtable::read_pack_cache(u64 hash, key_list const& ids, bin_table& tab, pack_cache_index& idx) const
+{
+	std::string const fname(pack_cache_file(hash));
+	u64 size;
+	if (!filesystem::get_file_size(fname.c_str(), size)) {
+		return (false);
+	}
+	try {
+		ifarchive ifa(fname.c_str());
+		u32 magic = 0;
+		u64 file_hash = 0;
+		u32 rows = 0;
+		u32 str_cnt = 0;
+		u32 seq_cnt = 0;
+		u32 sym_cnt = 0;
+		if (!(ifa >> magic >> file_hash >> rows >> str_cnt >> seq_cnt >> sym_cnt) ||
+			(magic != pack_cache_magic) || (file_hash != hash) ||
+			(rows != ids.size()) || (str_cnt != rows) || (0 == sym_cnt) ||
+			// the file size is checked before the tables are allocated
+			(size != u64(ifa.tellg()) + u64(str_cnt) * 4 + u64(seq_cnt) * 2 + u64(sym_cnt) * 4 + 8)) {
+			throw std::invalid_argument("invalid pack cache entry");
+		}
+		u64 checksum = 0;
+		tab.str_tab.clear();
+		tab.seq_tab.clear();
+		tab.sym_tab.clear();
+		if (!ifa.read(tab.str_tab, str_cnt) || !ifa.read(tab.seq_tab, seq_cnt) || !ifa.read(tab.sym_tab, sym_cnt) || !(ifa >> checksum)) {
+			throw std::invalid_argument("truncated pack cache entry");
+		}
+		if (checksum != fnv1a64_update(fnv1a64_update(fnv1a64_update(fnv1a64_init, tab.str_tab), tab.seq_tab), tab.sym_tab)) {
+			throw std::invalid_argument("corrupted pack cache entry");
+		}
+	} catch (std::exception& e) {
+		std::wclog << L";warn: ignoring " << to_wstring(fname) << L" (" << to_wstring(std::string(e.what())) << L")" << std::endl;
+		tab.str_tab.clear();
+		tab.seq_tab.clear();
+		tab.sym_tab.clear();
+		return (false);
+	}
+	pack_cache_entry& ent = idx.entries[hash];
+	ent.size = size;
+	ent.used = idx.session;
+	return (true);
+}
+
+void
+stringtable::save_pack_cache(u64 hash, key_list const& ids, bin_table const& tab, pack_cache_index& idx) const
+{
+	std::ostringstream data(std::ios_base::out | std::ios_base::binary);
+	{
+		osarchive osa(data, archive::little_endian);
+		osa << u32(pack_cache_magic) << hash << u32(ids.size());
+		osa << u32(tab.str_tab.size()) << u32(tab.seq_tab.size()) << u32(tab.sym_tab.size());
+		osa << tab.str_tab << tab.seq_tab << tab.sym_tab;
+		osa << fnv1a64_update(fnv1a64_update(fnv1a64_update(fnv1a64_init, tab.str_tab), tab.seq_tab), tab.sym_tab);
+		if (!osa) {
+			return;
+		}
+	}
+	std::string const fname(pack_cache_file(hash));
+	std::string const file(data.str());
+	bool written = false;
+	filesystem::ensure_directories(fname.c_str());
+	// written through a temporary file (no truncated entries)
+	if (!filesystem::update_file(fname.c_str(), file.data(), file.size(), written)) {
+		std::wclog << L";warn: failed to write " << to_wstring(fname) << std::endl;
+		return;
+	}
+	pack_cache_entry& ent = idx.entries[hash];
+	ent.size = u64(file.size());
+	ent.used = idx.session;
+}
+
+stringtable::bin_table const&
+stringtable::pack_col_cached(col_list::size_type col_idx, key_list const& ids, compression comp, pack_cache_index* cache, pack_origin& origin)
+{
+	// a new id changes the row order of every packed column
+	if (m_packed_ids != ids.size()) {
+		m_packed.clear();
+		m_packed_ids = ids.size();
+	}
+	column const& col = m_col[col_idx];
+	packed_column& packed = m_packed[std::make_pair(col_idx, comp)];
+	if (!packed.tab.sym_tab.empty() && (packed.revision == col.revision())) {
+		origin = pack_origin_reused;
+		return (packed.tab);
+	}
+	origin = pack_origin_packed;
+	if (!cache) {
+		pack_col(col, ids, packed.tab, comp);
+	} else {
+		u64 const hash = pack_col_hash(col, ids, comp);
+		if (read_pack_cache(hash, ids, packed.tab, *cache)) {
+			origin = pack_origin_cached;
+		} else {
+			pack_col(col, ids, packed.tab, comp);
+			save_pack_cache(hash, ids, packed.tab, *cache);
+		}
+	}
+	packed.revision = col.revision();
+	return (packed.tab);
+}
+
+stringtable::bin_target
+stringtable::make_bin_target(platform bin_plat, u8 bin_vers, char const* bin_path)
 {
 	if (bin_plat == platform_unknown) {
 		bin_plat = platform_x64;
@@ -1949,135 +4147,414 @@ stringtable::save_bin(platform bin_plat, u8 bin_vers, char const* bin_path, comp
 			break;
 		}
 	}
-	std::string fname(bin_path);
-	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	bin_target target;
+	target.plat = bin_plat;
+	target.vers = bin_vers;
+	target.path = bin_path;
+	target.output = 0;
+	return (target);
+}
+
+void
+stringtable::save_bin(platform bin_plat, u8 bin_vers, char const* bin_path, compression comp, byte_string const& filter)
+{
+	save_bin(bin_target_list(1, make_bin_target(bin_plat, bin_vers, bin_path)), comp, filter);
+}
+
+void
+stringtable::save_bin(oarchive& bin, platform bin_plat, u8 bin_vers, compression comp, byte_string const& filter)
+{
+	bin_target target(make_bin_target(bin_plat, bin_vers, "(archive)"));
+	target.output = &bin;
+	if (bin.endianness() != archive::platform_endianess(target.plat)) {
+		throw std::invalid_argument("archive byte order does not match the target platform");
+	}
+	save_bin(bin_target_list(1, target), comp, filter);
+}
+
+void
+stringtable::save_bin(bin_target_list const& targets, compression comp, byte_string const& filter)
+{
+	if (targets.empty()) {
+		return;
+	}
+	// two writers of one file (e.g. the pc and x64 default path) would corrupt it
+	{
+		std::set<std::string> paths;
+		for (bin_target_list::const_iterator t = targets.begin(); t != targets.end(); ++t) {
+			if (!t->output && !paths.insert(filesystem::file_identity(t->path.c_str())).second) {
+				throw std::invalid_argument("duplicate bin target path " + t->path);
+			}
+		}
+	}
+	// the packed tables only depend on the strings, the targets differ
+	// in the byte order and version (the layout is the same for all)
+	bin_target const& first = targets.front();
+	std::wcout << L"[" << to_wstring(first.path) << L"]" << std::endl;
 	std::wcout << L"filter=" << to_wstring(filter) << std::endl;
-	std::vector<col_list::size_type> col_idx;
+	profile::scope prof("save_bin", first.path);
+	bin_image img;
 	for (col_list::const_iterator pcol = m_col.begin(); pcol != m_col.end(); ++pcol) {
 		if (pcol->match(filter)) {
-			col_idx.push_back(static_cast<col_list::size_type>(pcol - m_col.begin()));
+			img.col_idx.push_back(static_cast<col_list::size_type>(pcol - m_col.begin()));
 		}
 	}
-	if (col_idx.empty()) {
+	if (img.col_idx.empty()) {
 		throw std::invalid_argument("no matching column found");
 	}
+	img.hdr = bin_header(first.vers);
+	img.key_tab = get_id_keys();
+	plan_bin_image(img);
+	std::wcout << L"target=" << to_wstring(std::string(platform_name(first.plat))) << std::endl;
+	std::wcout << L"version=" << to_wstring(img.hdr.version()) << std::endl;
+	std::wcout << L"strings=" << to_wstring(m_ids.size()) << std::endl;
+	std::wcout << L"columns=" << to_wstring(img.col_idx.size()) << L"/" << to_wstring(m_col.size()) << std::endl;
+	// the string tables are streamed to all targets as soon as they are
+	// packed, the header and the column table are written at the end
+	owner_list<bin_writer> writers;
+	for (bin_target_list::const_iterator t = targets.begin(); t != targets.end(); ++t) {
+		writers.push_back(new bin_writer(*this, img, *t));
+	}
+	pack_cache_index cache;
+	bool const use_cache = !m_pack_cache.empty();
+	if (use_cache) {
+		read_pack_cache_index(cache);
+	}
+	archive::streampos pos = img.str_pos;
+	std::size_t empty_tab = std::size_t(-1);
+	std::size_t verified = 0;
+	for (std::size_t i = 0; i < img.col_tab.size(); ++i) {
+		column const& col = m_col[img.col_idx[i]];
+		bin_column& bin = img.col_tab[i];
+		std::wcout << L"column." << to_wstring(i) << L".name=" << to_wstring(col.name) << std::endl;
+		if (col.empty() && (empty_tab != std::size_t(-1))) {
+			bin = img.col_tab[empty_tab];
+			continue;
+		}
+		pack_origin origin = pack_origin_packed;
+		bin_table const& tab = pack_col_cached(img.col_idx[i], img.key_tab, comp, use_cache ? &cache : 0, origin);
+		if (pack_origin_reused == origin) {
+			std::wcout << L"column." << to_wstring(i) << L".reused=1" << std::endl;
+		} else if (pack_origin_cached == origin) {
+			std::wcout << L"column." << to_wstring(i) << L".cached=1" << std::endl;
+		}
+
+		bin.str_tab.pos = pos;
+		bin.str_tab.size = static_cast<archive::streamsize>(tab.str_tab.size() * sizeof(u32) + tab.seq_tab.size() * sizeof(u16));
+		bin.sym_tab.pos = pos + bin.str_tab.size;
+		bin.sym_tab.size = static_cast<archive::streamsize>(tab.sym_tab.size() * sizeof(u32));
+		pos = bin.sym_tab.pos + bin.sym_tab.size;
+		for (std::size_t t = 0; t < writers.size(); ++t) {
+			writers[t].write_table(tab);
+		}
+		if (m_verify_bin) {
+			// decoded before the files get their signature
+			verify_bin_table(img.col_idx[i], img.key_tab, tab);
+			++verified;
+		}
+		if (col.empty()) {
+			if (std::size_t(-1) == empty_tab) {
+				// save index to merge the next empty column
+				empty_tab = i;
+			}
+		} else {
+			std::wcout << L"column." << to_wstring(i) << L".seq_avg=" << std::fixed << ((double)tab.seq_tab.size() / (double)col.size()) << std::endl;
+			std::wcout << L"column." << to_wstring(i) << L".seq_num=" << to_wstring(tab.seq_tab.size()) << std::endl;
+			std::wcout << L"column." << to_wstring(i) << L".sym_num=" << to_wstring(tab.sym_tab.size()) << std::endl;
+		}
+		if (!m_keep_packed) {
+			// only one packed column in memory
+			m_packed.erase(std::make_pair(img.col_idx[i], comp));
+		}
+	}
+	if (use_cache) {
+		save_pack_cache_index(cache);
+	}
+	if (m_verify_bin) {
+		std::wcout << L"verified=" << to_wstring(verified) << std::endl;
+	}
+	for (std::size_t t = 0; t < writers.size(); ++t) {
+		bin_target const& target = targets[t];
+		if (t > 0) {
+			std::wcout << L"[" << to_wstring(target.path) << L"]" << std::endl;
+			std::wcout << L"filter=" << to_wstring(filter) << std::endl;
+			std::wcout << L"target=" << to_wstring(std::string(platform_name(target.plat))) << std::endl;
+			std::wcout << L"version=" << to_wstring(target.vers) << std::endl;
+			std::wcout << L"strings=" << to_wstring(m_ids.size()) << std::endl;
+			std::wcout << L"columns=" << to_wstring(img.col_idx.size()) << L"/" << to_wstring(m_col.size()) << std::endl;
+		}
+		writers[t].finish(pos);
+		std::wcout << std::endl;
+	}
+	prof.add_items(img.col_tab.size() * writers.size());
+	prof.add_bytes_out(u64(pos) * writers.size());
+}
+
+void
+stringtable::plan_bin_image(bin_image& img) const
+{
+	// all offsets up to the first string table (computed from the sizes)
+	// (starting after the archive header)
+	archive::streampos pos = onarchive().tellp() + static_cast<archive::streamsize>(sizeof(bin_header));
+	img.hdr.src_count = static_cast<archive::streamsize>(m_src.size());
+	img.hdr.col_count = static_cast<archive::streamsize>(img.col_idx.size());
+	img.hdr.row_count = static_cast<archive::streamsize>(m_ids.size());
+	// source table (u16 length-prefixed path, u32[2] time)
+	img.hdr.src_table = pos;
+	img.src_tab.clear();
+	img.src_tab.reserve(m_src.size());
+	for (src_list::const_iterator psrc = m_src.begin(); psrc != m_src.end(); ++psrc) {
+		bin_source const& src = *img.src_tab.insert(img.src_tab.end(), bin_source(*psrc));
+		if (src.csv_path.length() > u16(-1)) {
+			throw std::runtime_error("failed to write binary string table");
+		}
+		pos += static_cast<archive::streamsize>(sizeof(u16) + src.csv_path.length() + sizeof(u32[2]));
+	}
+	pos = align_streampos(pos, sizeof(u32));
+	// column names (0-terminated, u32-aligned)
+	img.hdr.col_names = pos;
+	img.col_str.assign(img.col_idx.size(), archive::streamref());
+	pos += static_cast<archive::streamsize>(img.col_str.size() * sizeof(archive::streamref));
+	for (std::size_t i = 0; i < img.col_idx.size(); ++i) {
+		byte_string const& str = m_col[img.col_idx[i]].name;
+		archive::streamref& ref = img.col_str[i];
+		ref.pos = pos;
+		ref.size = static_cast<archive::streamsize>(align_streampos(byte_string::traits_type::length(str.c_str()) + 1, sizeof(u32)));
+		pos += ref.size;
+	}
+	// column table
+	img.hdr.col_table = pos;
+	img.col_tab.assign(img.col_idx.size(), bin_column());
+	pos += static_cast<archive::streamsize>(img.col_tab.size() * sizeof(bin_column));
+	// key table
+	img.hdr.key_table = pos;
+	pos += static_cast<archive::streamsize>(sizeof(archive::streamref));
+	img.key_ref.pos = pos;
+	img.key_ref.size = static_cast<archive::streamsize>(img.key_tab.size() * sizeof(string_hash));
+	pos += img.key_ref.size;
+	img.str_pos = pos;
+}
+
+void
+stringtable::save_state(char const* state_path)
+{
+	std::string fname((state_path && *state_path) ? state_path : default_state_path);
+	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("save_state", fname);
 	filesystem::ensure_directories(fname.c_str());
-	ofarchive ofa(fname.c_str(), bin_plat);
+	ofarchive ofa(fname.c_str(), archive::little_endian);
 	if (!ofa) {
-		throw std::runtime_error("failed to create binary string table");
+		throw std::runtime_error("failed to create state file");
 	}
-	bin_header hdr(bin_vers);
+	state_name_pool names;
+	std::vector<wide_char> texts;
+	state_header hdr;
 	hdr.src_count = static_cast<archive::streamsize>(m_src.size());
-	hdr.col_count = static_cast<archive::streamsize>(col_idx.size());
-	hdr.row_count = static_cast<archive::streamsize>(m_ids.size());
-	std::vector<bin_source> src_tab; src_tab.reserve(m_src.size());
-	std::vector<archive::streamref> col_str(col_idx.size());
-	std::vector<bin_column> col_tab(col_idx.size());
-	archive::streamref key_ref;
-	std::vector<string_hash> key_tab; key_tab.reserve(m_ids.size());
-	std::vector<bin_table> str_tab;
-	{
-		onarchive ona;
-		std::wcout << L"target=" << to_wstring(std::string(platform_name(bin_plat))) << std::endl;
-		// header
-		hdr.write(ona);
-		std::wcout << L"version=" << to_wstring(hdr.version()) << std::endl;
-		std::wcout << L"strings=" << to_wstring(m_ids.size()) << std::endl;
-		std::wcout << L"columns=" << to_wstring(col_idx.size()) << L"/" << to_wstring(m_col.size()) << std::endl;
-		// source table
-		hdr.src_table = ona.tellp();
-		for (src_list::const_iterator psrc = m_src.begin(); psrc != m_src.end(); ++psrc) {
-			bin_source src(*psrc);
-			src_tab.push_back(src);
-			src.write(ona);
+	hdr.map_count = static_cast<archive::streamsize>(m_map.size());
+	hdr.ids_count = static_cast<archive::streamsize>(m_ids.size());
+	hdr.col_count = static_cast<archive::streamsize>(m_col.size());
+	archive::streampos const hdr_pos = ofa.tellp();
+	hdr.write(ofa);
+	// source table
+	hdr.src_table = ofa.tellp();
+	for (src_list::const_iterator psrc = m_src.begin(); psrc != m_src.end(); ++psrc) {
+		u64 const ticks = psrc->get_modified().ticks();
+		state_source src;
+		src.csv_path = names.add(psrc->get_csv());
+		src.prefix = names.add(psrc->get_prefix());
+		src.modified[0] = static_cast<u32>(ticks >> 32);
+		src.modified[1] = static_cast<u32>(ticks);
+		ofa << reinterpret_cast<u32 const(&)[sizeof(state_source) / sizeof(u32)]>(src.csv_path);
+	}
+	// idname/idhash tables (hashes sorted by key_compare)
+	name_map const* const maps[2] = {&m_map, &m_ids};
+	for (std::size_t i = 0; i < 2; ++i) {
+		(i ? hdr.ids_table : hdr.map_table) = ofa.tellp();
+		key_list keys;
+		if (i) {
+			keys = get_id_keys();
+		} else {
+			m_map.sorted_keys(keys, true);
 		}
-		while (ona && (ona.tellp() % sizeof(u32))) {
-			ona << u8(0);
+		std::vector<u32> name_offs; name_offs.reserve(keys.size());
+		for (key_list::const_iterator pkey = keys.begin(); pkey != keys.end(); ++pkey) {
+			name_offs.push_back(names.add(make_name(maps[i]->find(*pkey)->second)));
 		}
-		// column names
-		hdr.col_names = ona.tellp();
-		ona << col_str;
-		for (std::size_t i = 0; i < col_idx.size(); ++i) {
-			byte_string const& str = m_col[col_idx[i]].name;
-			archive::streamref& ref = col_str[i];
-			write_ref_string(ona, str, ref, true, archive::streamsize(sizeof(u32)));
-		}
-		// column table
-		hdr.col_table = ona.tellp();
-		ona.write(&col_tab[0].str_tab.size, hdr.col_count * 4);
-		// key table
-		hdr.key_table = ona.tellp();
-		ona << key_ref;
-		key_ref = ona.ref_begin();
-		for (name_map::const_iterator pkey = m_ids.begin(); pkey != m_ids.end(); ++pkey) {
-			key_tab.push_back(pkey->first);
-		}
-		ona << key_tab;
-		ona.ref_end(key_ref);
-		// string tables
-		std::size_t empty_tab = std::size_t(-1);
-		for (std::size_t i = 0; i < col_tab.size(); ++i) {
-			column const& col = m_col[col_idx[i]];
-			bin_column& bin = col_tab[i];
-			std::wcout << L"column." << to_wstring(i) << L".name=" << to_wstring(col.name) << std::endl;
-			if (col.rows.empty() && (empty_tab != std::size_t(-1))) {
-				bin = col_tab[empty_tab];
-			} else {
-				bin_table& tab = *str_tab.insert(str_tab.end(), bin_table());
-
-				pack_col(col, tab, comp);
-
-				bin.str_tab = ona.ref_begin();
-				ona << tab.str_tab;
-				ona << tab.seq_tab;
-				ona.ref_end(bin.str_tab);
-				bin.sym_tab = ona.ref_begin();
-				ona << tab.sym_tab;
-				ona.ref_end(bin.sym_tab);
-				if (col.rows.empty()) {
-					if (std::size_t(-1) == empty_tab) {
-						// save index to merge the next empty column
-						empty_tab = i;
-					}
-				} else {
-					std::wcout << L"column." << to_wstring(i) << L".seq_avg=" << std::fixed << ((double)tab.seq_tab.size() / (double)col.rows.size()) << std::endl;
-					std::wcout << L"column." << to_wstring(i) << L".seq_num=" << to_wstring(tab.seq_tab.size()) << std::endl;
-					std::wcout << L"column." << to_wstring(i) << L".sym_num=" << to_wstring(tab.sym_tab.size()) << std::endl;
-				}
-			}
+		ofa << keys;
+		ofa << name_offs;
+	}
+	// column rows
+	std::vector<state_column> col_tab(m_col.size());
+	for (std::size_t i = 0; i < m_col.size(); ++i) {
+		column const& col = m_col[i];
+		state_column& sta = col_tab[i];
+		sta.name = names.add(col.name);
+		sta.row_count = static_cast<archive::streamsize>(col.size());
+		// the column pool is appended, so only the offsets need a rebase
+		u32 const base = static_cast<u32>(texts.size());
+		std::vector<u32> text_offs(col.offsets());
+		for (std::vector<u32>::iterator poff = text_offs.begin(); poff != text_offs.end(); ++poff) {
+			*poff += base;
 		}
+		texts.insert(texts.end(), col.pool().begin(), col.pool().end());
+		sta.row_keys = ofa.tellp();
+		ofa << col.keys();
+		sta.row_text = ofa.tellp();
+		ofa << text_offs;
 	}
+	// column table
+	hdr.col_table = ofa.tellp();
+	for (std::vector<state_column>::const_iterator pcol = col_tab.begin(); pcol != col_tab.end(); ++pcol) {
+		ofa << reinterpret_cast<u32 const(&)[sizeof(state_column) / sizeof(u32)]>(pcol->name);
+	}
+	// name pool
+	hdr.name_pool.pos = ofa.tellp();
+	hdr.name_pool.size = static_cast<archive::streamsize>(names.data().size());
+	ofa << names.data();
+	while (ofa && (ofa.tellp() % sizeof(u32))) {
+		ofa << u8(0);
+	}
+	// text pool
+	hdr.text_pool.pos = ofa.tellp();
+	hdr.text_pool.size = static_cast<archive::streamsize>(texts.size() * sizeof(wide_char));
+	ofa << texts;
+	while (ofa && (ofa.tellp() % sizeof(u32))) {
+		ofa << u8(0);
+	}
+	prof.add_items(m_ids.size());
+	prof.add_bytes_out(ofa.tellp());
 	// header
+	ofa.seekp(hdr_pos);
 	hdr.write(ofa);
+	if (!ofa) {
+		throw std::runtime_error("failed to write state file");
+	}
+	std::wcout << L"source.count=" << to_wstring(hdr.src_count) << std::endl;
+	std::wcout << L"idname.count=" << to_wstring(hdr.map_count) << std::endl;
+	std::wcout << L"idhash.count=" << to_wstring(hdr.ids_count) << std::endl;
+	std::wcout << L"column.count=" << to_wstring(hdr.col_count) << std::endl;
+	std::wcout << std::endl;
+}
+
+void
+stringtable::load_state(char const* state_path)
+{
+	std::string fname((state_path && *state_path) ? state_path : default_state_path);
+	std::wcout << L"[" << to_wstring(fname) << L"]" << std::endl;
+	profile::scope prof("load_state", fname);
+	u64 fsize = 0;
+	if (!filesystem::get_file_size(fname.c_str(), fsize)) {
+		throw std::runtime_error("failed to open state file");
+	}
+	prof.add_bytes_in(fsize);
+	// no table can hold more 32-bit entries than the file
+	archive::streamsize const max_count = static_cast<archive::streamsize>(
+		std::min<u64>(fsize / sizeof(u32), archive::streamsize_limits<u32>::max_count()));
+	ifarchive ifa(fname.c_str());
+	state_header hdr;
+	if (!hdr.read(ifa)) {
+		throw std::invalid_argument("failed to read state header");
+	}
+	if ((hdr.magic & 0x00FFFFFFUL) != 0x00535453UL) {
+		throw std::invalid_argument("invalid state signature");
+	}
+	if (hdr.version() != state_header().version()) {
+		throw std::invalid_argument("unsupported state version");
+	}
+	if ((hdr.src_count > max_count) || (hdr.map_count > max_count) ||
+		(hdr.ids_count > max_count) || (hdr.col_count > max_count) ||
+		(hdr.name_pool.size > fsize) || (hdr.text_pool.size > fsize) ||
+		(hdr.name_pool.size < 1) || (hdr.text_pool.size % sizeof(wide_char))) {
+		throw std::invalid_argument("invalid state header");
+	}
+	// all tables are validated before the current ones are replaced
+	stringtable sta;
+	sta.read_state(ifa, hdr, max_count);
+	swap_tables(sta);
+	std::wcout << L"source.count=" << to_wstring(m_src.size()) << std::endl;
+	std::wcout << L"idname.count=" << to_wstring(m_map.size()) << std::endl;
+	std::wcout << L"idhash.count=" << to_wstring(m_ids.size()) << std::endl;
+	std::wcout << L"column.count=" << to_wstring(m_col.size()) << std::endl;
+	std::wcout << std::endl;
+}
+
+void
+stringtable::read_state(iarchive& ifa, state_header const& hdr, archive::streamsize max_count)
+{
+	// pools
+	std::vector<byte_char> names;
+	std::vector<wide_char> texts;
+	if (!ifa.seekg(hdr.name_pool.pos) || !ifa.read(names, hdr.name_pool.size) || names.back()) {
+		throw std::invalid_argument("failed to read state name pool");
+	}
+	if ((hdr.text_pool.size > 0) &&
+		(!ifa.seekg(hdr.text_pool.pos) || !ifa.read(texts, hdr.text_pool.size / sizeof(wide_char)))) {
+		throw std::invalid_argument("failed to read state text pool");
+	}
 	// source table
-	for (std::vector<bin_source>::const_iterator psrc = src_tab.begin(); psrc != src_tab.end(); ++psrc) {
-		psrc->write(ofa);
+	if (!ifa.seekg(hdr.src_table)) {
+		throw std::invalid_argument("invalid state source table offset");
 	}
-	while (ofa && (ofa.tellp() % sizeof(u32))) {
-		ofa << u8(0);
+	for (archive::streamsize i = 0; i < hdr.src_count; ++i) {
+		state_source src;
+		if (!(ifa >> reinterpret_cast<u32(&)[sizeof(state_source) / sizeof(u32)]>(src.csv_path))) {
+			throw std::invalid_argument("failed to read state source table");
+		}
+		source& s = add_src(get_state_name(names, src.csv_path));
+		s.set_prefix(get_state_name(names, src.prefix));
+		s.set_modified(filetime((u64(src.modified[0]) << 32) | src.modified[1]));
 	}
-	// column names
-	ofa << col_str;
-	for (std::size_t i = 0; i < col_idx.size(); ++i) {
-		byte_string const& str = m_col[col_idx[i]].name;
-		archive::streamref ref;
-		write_ref_string(ofa, str, ref, true, archive::streamsize(sizeof(u32)));
+	// idname/idhash tables
+	name_map* const maps[2] = {&m_map, &m_ids};
+	for (std::size_t i = 0; i < 2; ++i) {
+		archive::streamsize const count = i ? hdr.ids_count : hdr.map_count;
+		std::vector<string_hash> keys;
+		std::vector<u32> name_offs;
+		if ((count > 0) && (!ifa.seekg(i ? hdr.ids_table : hdr.map_table) ||
+			!ifa.read(keys, count) || !ifa.read(name_offs, count))) {
+			throw std::invalid_argument("failed to read state idhash table");
+		}
+		name_map& map = *maps[i];
+		map.reserve(count);
+		for (archive::streamsize j = 0; j < count; ++j) {
+			map.insert(std::make_pair(keys[j], intern_name(get_state_name(names, name_offs[j]))));
+		}
 	}
 	// column table
-	ofa.write(&col_tab[0].str_tab.size, hdr.col_count * 4);
-	// key table
-	ofa << key_ref;
-	ofa << key_tab;
-	// strings tables
-	for (std::vector<bin_table>::const_iterator ptab = str_tab.begin(); ptab != str_tab.end(); ++ptab) {
-		ofa << ptab->str_tab;
-		ofa << ptab->seq_tab;
-		ofa << ptab->sym_tab;
+	std::vector<state_column> col_tab(hdr.col_count);
+	if ((hdr.col_count > 0) && !ifa.seekg(hdr.col_table)) {
+		throw std::invalid_argument("invalid state column table offset");
 	}
-	if (!ofa) {
-		throw std::runtime_error("failed to write binary string table");
+	for (std::vector<state_column>::iterator pcol = col_tab.begin(); pcol != col_tab.end(); ++pcol) {
+		if (!(ifa >> reinterpret_cast<u32(&)[sizeof(state_column) / sizeof(u32)]>(pcol->name)) ||
+			(pcol->row_count > max_count)) {
+			throw std::invalid_argument("failed to read state column table");
+		}
+	}
+	// column rows
+	for (std::vector<state_column>::const_iterator pcol = col_tab.begin(); pcol != col_tab.end(); ++pcol) {
+		column& col = m_col[add_col(get_state_name(names, pcol->name))];
+		std::vector<string_hash> keys;
+		std::vector<u32> text_offs;
+		if ((pcol->row_count > 0) &&
+			(!ifa.seekg(pcol->row_keys) || !ifa.read(keys, pcol->row_count))) {
+			throw std::invalid_argument("failed to read state column keys");
+		}
+		if (!ifa.seekg(pcol->row_text) || !ifa.read(text_offs, pcol->row_count + 1)) {
+			throw std::invalid_argument("failed to read state column texts");
+		}
+		for (archive::streamsize j = 0; j < pcol->row_count; ++j) {
+			u32 const beg = text_offs[j];
+			u32 const end = text_offs[j + 1];
+			if ((beg > end) || (end > texts.size())) {
+				throw std::invalid_argument("invalid state column text offset");
+			}
+			if (beg < end) {
+				col.set(keys[j], text_ref(&texts[beg], &texts[beg] + (end - beg)));
+			}
+		}
+		col.commit();
 	}
-	std::wcout << std::endl;
 }
 
 byte_string
@@ -2087,7 +4564,7 @@ stringtable::get_id_name(string_hash const& key) const
 	if (pos != m_ids.end()) {
 		name_map::mapped_type const& name = pos->second;
 		if (!name.empty()) {
-			return (name);
+			return (make_name(name));
 		}
 	}
 	return (hash_to_string(key));
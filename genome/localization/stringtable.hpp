@@ -25,6 +25,7 @@
 #include <genome/genome.hpp>
 #include <genome/archive.hpp>
 #include <genome/hash.hpp>
+#include <genome/hash_table.hpp>
 #include <genome/string.hpp>
 #include <genome/time.hpp>
 #include <functional>
@@ -53,9 +54,38 @@ public:
 	};
 	typedef std::vector<string_hash> key_list;
 	typedef std::greater<string_hash> key_compare;  // required hash order in binary format
-	typedef std::map<string_hash, byte_string, key_compare> name_map;
 	typedef std::map<string_hash, wide_string, key_compare> text_map;
 	typedef std::vector<wide_string> text_list;
+	struct bin_target {
+		platform    plat;
+		u8          vers;
+		std::string path;
+		oarchive*   output;  // written instead of path (if not null)
+	};
+	typedef std::vector<bin_target> bin_target_list;
+
+	class name_arena {
+	public:
+		// interned 0-terminated byte strings, referenced by their offset
+		typedef u32 handle;  // 0 = empty string
+		name_arena(void);
+		handle intern(byte_string const& str);
+		byte_char const* c_str(handle str) const;  // invalidated by intern()
+		std::size_t bytes(void) const;
+		std::size_t heap_bytes(void) const;  // allocated capacity (including the index)
+		void clear(void);
+		void swap(name_arena& other);
+	private:
+		std::vector<byte_char> m_data;
+		hash_table<handle>     m_index;  // hash_byte() -> first string with this hash
+		std::map<handle, handle> m_next; // next string with the same hash (collisions only)
+	};
+	struct id_name {
+		name_arena::handle prefix;  // "prefix:" including the colon (0 = none)
+		name_arena::handle id;      // 0 = unknown name
+		bool empty(void) const;
+	};
+	typedef hash_table<id_name> name_map;  // unordered, see get_id_keys()
 
 	class source {
 	public:
@@ -76,27 +106,110 @@ public:
 	};
 	typedef std::vector<source> src_list;
 
+	class text_ref {
+	public:
+		// read-only view of a column string (invalidated by column::commit)
+		typedef wide_char const* const_iterator;
+		typedef std::size_t size_type;
+		text_ref(void);
+		text_ref(const_iterator first, const_iterator last);
+		const_iterator begin(void) const;
+		const_iterator end(void) const;
+		size_type size(void) const;
+		bool empty(void) const;
+		bool equals(wide_string const& str) const;
+		wide_string str(void) const;
+	private:
+		const_iterator m_first;
+		const_iterator m_last;
+	};
+
 	struct column {
+		typedef std::size_t size_type;
 		byte_string name;
 		string_hash name_hash;
-		text_map    rows;  // only non-empty strings
 		column(byte_string const& col_name);
 		bool match(byte_string const& filter) const;
+		// committed rows (only non-empty strings, in key_compare order)
+		bool empty(void) const;
+		size_type size(void) const;
+		string_hash const& key(size_type row) const;
+		text_ref text(size_type row) const;
+		size_type find(string_hash const& key) const;  // size() if not found
+		text_ref find_text(string_hash const& key) const;
+		key_list const& keys(void) const;
+		std::vector<u32> const& offsets(void) const;  // size() + 1 pool offsets
+		std::vector<wide_char> const& pool(void) const;
+		// pending changes (last set wins, empty text removes the row)
+		void set(string_hash const& key, wide_string const& str);
+		void set(string_hash const& key, text_ref const& str);
+		void commit(void);
+		void clear(void);
+		u32 revision(void) const;  // changed by every commit/clear
+		std::size_t heap_bytes(void) const;  // allocated capacity (including pending rows)
+	private:
+		struct pending_row {
+			string_hash key;
+			u32         beg;
+			u32         end;
+		};
+		struct pending_row_compare {
+			bool operator()(pending_row const& lhs, pending_row const& rhs) const;
+		};
+		key_list                 m_keys;
+		std::vector<u32>         m_offs;
+		std::vector<wide_char>   m_pool;
+		std::vector<pending_row> m_pending;
+		std::vector<wide_char>   m_pending_pool;
+		u32                      m_revision;
 	};
 	typedef std::vector<column> col_list;
 
+	class row_cursor {
+	public:
+		// merge-join of the id table and a column (both in key_compare order),
+		// yields every id row with its column string (empty if not present),
+		// starting at the id row 'first'
+		row_cursor(key_list const& ids, column const& col, std::size_t first = 0);
+		bool valid(void) const;
+		void next(void);
+		std::size_t index(void) const;  // row index in the id table
+		string_hash const& key(void) const;
+		text_ref const& text(void) const;
+	private:
+		void seek(void);
+		key_list const*   m_ids;
+		column const*     m_col;
+		column::size_type m_row;
+		std::size_t       m_index;
+		text_ref          m_text;
+	};
+
 	stringtable(void);
 	~stringtable(void);
 	void clear(void);
+	void set_skip_unchanged(bool skip);  // save_csv/save_map/save_bin/recover_ids (not reset by clear)
+	void set_pack_cache(char const* cache_dir, u64 size_limit);  // save_bin (not reset by clear, 0 = disabled)
+	void set_verify_bin(bool verify);  // save_bin (not reset by clear)
+	void set_keep_packed(bool keep);  // save_bin (not reset by clear)
 	source& add_src(byte_string const& csv_path);
 	std::size_t add_col(byte_string const& col_name);
 	void read_map(char const* csv_path);
 	void read_bin(char const* bin_path);
+	void read_bin(iarchive& bin);
+	static void print_bin_info(std::vector<std::string> const& bin_paths);  // tables/statistics only (no strings)
+	void print_memory(void) const;  // heap counters and container capacities (in octets)
 	void read_ini(char const* ini_path);
 	void save_csv(void);
-	void read_csv(bool utf = false);
+	void read_csv(bool utf = false, char const* cache_path = 0);
 	void save_map(char const* csv_path);
+	void recover_ids(char const* csv_path, std::size_t max_length, char const* word_path);
 	void save_bin(platform bin_plat, u8 bin_vers, char const* bin_path, compression comp, byte_string const& filter);
+	void save_bin(bin_target_list const& targets, compression comp, byte_string const& filter);
+	void save_bin(oarchive& bin, platform bin_plat, u8 bin_vers, compression comp, byte_string const& filter);  // bin.tellp() at the header end
+	static bin_target make_bin_target(platform bin_plat, u8 bin_vers, char const* bin_path);  // with defaults
+	void save_state(char const* state_path);
+	void load_state(char const* state_path);
 	byte_string get_id_name(string_hash const& key) const;
 private:
 	struct bin_header {
@@ -149,6 +262,7 @@ private:
 		u32 get_next_sequence(void) const;
 		u16 get_next_symbol(void) const;
 		bool symbols_full(void) const;
+		std::size_t heap_bytes(void) const;  // allocated capacity of the tables
 		static GENOME_CONSTEXPR_INLINE
 		u32 make_char_symbol(wide_char chr)
 		{
@@ -170,28 +284,160 @@ private:
 			return (static_cast<u16>(sym));
 		}
 	};
+	struct bin_image {
+		// layout up to the string tables (independent of the target platform)
+		bin_image(void);
+		bin_header                       hdr;
+		std::vector<col_list::size_type> col_idx;
+		std::vector<bin_source>          src_tab;
+		std::vector<archive::streamref>  col_str;
+		std::vector<bin_column>          col_tab;
+		archive::streamref               key_ref;
+		key_list                         key_tab;
+		archive::streampos               str_pos;  // offset of the first string table
+	};
+	void plan_bin_image(bin_image& img) const;
+	class bin_writer;
+	friend class bin_writer;
+	struct state_header {
+		// do not change the member types and/or order (streamed as u32[13])
+		u32                 magic;      // fourcc_le(u8'S', u8'T', u8'S', version)
+		archive::streamsize src_count;
+		archive::streamsize map_count;
+		archive::streamsize ids_count;
+		archive::streamsize col_count;
+		archive::streamref  name_pool;  // byte_char[], 0-terminated names
+		archive::streamref  text_pool;  // wide_char[], not terminated
+		archive::streampos  src_table;  // state_source[src_count]
+		archive::streampos  map_table;  // string_hash[map_count], u32 name[map_count]
+		archive::streampos  ids_table;  // string_hash[ids_count], u32 name[ids_count]
+		archive::streampos  col_table;  // state_column[col_count]
+		state_header(void);
+		iarchive& read(iarchive& sta);
+		oarchive& write(oarchive& sta) const;
+		u8 version(void) const;
+	};
+	GENOME_STATIC_ASSERT(state_header_size, 416 == (sizeof(state_header) * CHAR_BIT),
+		"stringtable::state_header must be 13 * 32-bit in size.");
+	struct state_source {
+		// do not change the member types and/or order (streamed as u32[4])
+		u32 csv_path;     // name_pool offset
+		u32 prefix;       // name_pool offset
+		u32 modified[2];  // swapped Windows FILETIME
+	};
+	GENOME_STATIC_ASSERT(state_source_size, 128 == (sizeof(state_source) * CHAR_BIT),
+		"stringtable::state_source must be 4 * 32-bit in size.");
+	struct state_column {
+		// do not change the member types and/or order (streamed as u32[4])
+		u32                 name;       // name_pool offset
+		archive::streamsize row_count;
+		archive::streampos  row_keys;   // string_hash[row_count] (key_compare order)
+		archive::streampos  row_text;   // u32[row_count + 1] text_pool offsets
+	};
+	GENOME_STATIC_ASSERT(state_column_size, 128 == (sizeof(state_column) * CHAR_BIT),
+		"stringtable::state_column must be 4 * 32-bit in size.");
+	void read_state(iarchive& sta, state_header const& hdr, archive::streamsize max_count);  // into empty tables
+	void swap_tables(stringtable& other);  // all tables (not the settings)
+	struct csv_record {
+		u32         line;  // line number in the CSV file (for diagnostics)
+		byte_string id;    // first field (string identifier or hash)
+		text_list   text;  // remaining fields (unescaped)
+	};
+	struct csv_table {
+		std::vector<byte_string> cols;  // column names (without "ID")
+		std::vector<csv_record>  recs;
+		bool                     ansi;  // Windows-1252 encoding (warned on every read)
+	};
+	struct csv_cache_entry {
+		// do not reuse the parsed table if the file changed (time and size)
+		byte_string csv_path;
+		filetime    modified;
+		u64         size;
+		bool        utf;
+		csv_table   table;
+	};
+	typedef std::vector<csv_cache_entry> csv_cache;
+	static void parse_csv(char const* csv_path, bool utf, csv_table& tab);
+	void apply_csv(source const& src, csv_table const& tab);  // rows are left pending (see read_csv)
+	class save_csv_task;
+	friend class save_csv_task;
+	bool save_csv_src(std::string const& csv, key_list const& keys, std::vector<name_arena::handle> const& names, wide_string const& head) const;
+	static void read_csv_cache(char const* cache_path, csv_cache& cache);
+	static void save_csv_cache(char const* cache_path, csv_cache const& cache);
 	void read_bin_src(iarchive& bin, bin_header const& hdr);
 	key_list read_bin_ids(iarchive& bin, bin_header const& hdr);
 	void read_bin_col(iarchive& bin, bin_header const& hdr, key_list const& ids);
-	void pack_col_none(column const& col, bin_table& tab) const;
-	void pack_col_fast(column const& col, bin_table& tab) const;
-	void pack_col_lzpb(column const& col, bin_table& tab, bool ext) const;
-	void pack_col_tree_char(column const& col, bin_table& tab, bool ext) const;
+	static u32 link_bin_symbols(std::vector<u32> const& seq_sym, std::vector<u32>& sym_len);
+	static void decode_bin_string(std::vector<u16> const& str_seq, std::vector<u32> const& seq_sym, std::vector<u32> const& sym_len, u32 beg, wide_string& str, wide_string::size_type& max_sub);
+	void verify_bin_table(col_list::size_type col_idx, key_list const& ids, bin_table const& tab) const;
+	void verify_bin_rows(column const& col, key_list const& ids, bin_table const& tab, std::vector<u32> const& sym_len, std::size_t first, std::size_t last) const;
+	class verify_bin_task;
+	friend class verify_bin_task;
+	static void inspect_bin(iarchive& bin, std::wostream& out);
+	static void measure_bin_table(std::vector<u32> const& str_beg, std::vector<u16> const& str_seq, std::vector<u32> const& seq_sym, wide_string::size_type& max_sub, wide_string::size_type& max_str);
+	class bin_info_task;
+	friend class bin_info_task;
+	id_name intern_name(byte_string const& name);
+	byte_string make_name(id_name const& name) const;
+	key_list const& get_id_keys(void) const;  // cached until an id is added
+	void pack_col_none(column const& col, key_list const& ids, bin_table& tab) const;
+	void pack_col_fast(column const& col, key_list const& ids, bin_table& tab) const;
+	void pack_col_lzpb(column const& col, key_list const& ids, bin_table& tab, bool ext) const;
+	void pack_col_tree_char(column const& col, key_list const& ids, bin_table& tab, bool ext) const;
 	struct pack_col_tree_node_sort_weight {
 		bool operator()(std::pair<std::size_t, std::size_t> const& a, std::pair<std::size_t, std::size_t> const& b) const
 		{
 			return (a.second > b.second);
 		}
 	};
-	void pack_col_tree_node(column const& col, bin_table& tab, bool ext) const;
-	void pack_col(column const& col, bin_table& tab, compression comp) const;
+	void pack_col_tree_node(column const& col, key_list const& ids, bin_table& tab, bool ext) const;
+	void pack_col(column const& col, key_list const& ids, bin_table& tab, compression comp) const;
+	struct packed_column {
+		packed_column(void);
+		u32       revision;  // column::revision() of the packed rows
+		bin_table tab;
+	};
+	typedef std::map<std::pair<col_list::size_type, compression>, packed_column> packed_column_map;
+	struct pack_cache_entry {
+		// <cache_dir>/<hash>.pkc, evicted in least recently used order
+		u64 size;
+		u32 used;  // session of the last lookup/store
+	};
+	struct pack_cache_index {
+		// <cache_dir>/index.pki
+		u32                             session;
+		std::map<u64, pack_cache_entry> entries;
+	};
+	u64 pack_col_hash(column const& col, key_list const& ids, compression comp) const;
+	std::string pack_cache_file(u64 hash) const;  // 0 = index file
+	void read_pack_cache_index(pack_cache_index& idx) const;  // reconciled with the *.pkc files
+	void save_pack_cache_index(pack_cache_index& idx) const;  // evicts entries above the size limit
+	bool read_pack_cache(u64 hash, key_list const& ids, bin_table& tab, pack_cache_index& idx) const;
+	void save_pack_cache(u64 hash, key_list const& ids, bin_table const& tab, pack_cache_index& idx) const;
+	enum pack_origin {
+		pack_origin_packed,  // compressed now
+		pack_origin_reused,  // already packed in this session
+		pack_origin_cached   // loaded from the pack cache
+	};
+	bin_table const& pack_col_cached(col_list::size_type col_idx, key_list const& ids, compression comp, pack_cache_index* cache, pack_origin& origin);
 private:
 	static text_list split_csv_line(wide_string const& csv_line);
 private:
-	name_map m_map;
-	src_list m_src;
-	name_map m_ids;
-	col_list m_col;
+	name_arena m_names;  // shared by m_map and m_ids
+	name_map   m_map;
+	src_list   m_src;
+	name_map   m_ids;
+	col_list   m_col;
+	mutable key_list m_id_keys;  // sorted m_ids keys (see get_id_keys)
+	bool       m_skip_unchanged;
+	bool       m_verify_bin;
+	bool       m_keep_packed;
+	// on-disk cache of packed tables (save_bin)
+	std::string m_pack_cache;        // directory (empty = disabled)
+	u64         m_pack_cache_limit;  // size limit (in octets)
+	// packed tables of this session (kept for other filters/targets if m_keep_packed)
+	packed_column_map   m_packed;
+	key_list::size_type m_packed_ids;  // id count of all m_packed entries (ids are only added until clear)
 };
 
 } // namespace genome::localization
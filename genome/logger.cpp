@@ -0,0 +1,353 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/logger.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <streambuf>
+
+namespace genome {
+namespace logger {
+
+namespace /*{anonymous}*/ {
+
+	struct line_entry {
+		explicit line_entry(level line_level)
+			: next(0)
+			, lvl(line_level)
+			, text()
+		{
+		}
+		line_entry* next;
+		level lvl;
+		std::string text;  // UTF-8 with newline
+	};
+
+	// the lines in emit order until the next flush
+	class line_queue {
+		line_queue(line_queue const&) GENOME_DELETE_FUNCTION;
+		line_queue& operator=(line_queue const&) GENOME_DELETE_FUNCTION;
+	public:
+		line_queue(void)
+			: m_head(0)
+			, m_tail(0)
+		{
+		}
+		~line_queue(void)
+		{
+			release(take());
+		}
+		void push(line_entry* entry)
+		{
+			entry->next = 0;
+			if (m_tail) {
+				m_tail->next = entry;
+			} else {
+				m_head = entry;
+			}
+			m_tail = entry;
+		}
+		line_entry* take(void)
+		{
+			line_entry* const lines = m_head;
+			m_head = 0;
+			m_tail = 0;
+			return (lines);
+		}
+		static void release(line_entry* entry)
+		{
+			while (entry) {
+				line_entry* const next = entry->next;
+				delete entry;
+				entry = next;
+			}
+		}
+	private:
+		line_entry* m_head;
+		line_entry* m_tail;
+	};
+
+	// UTF-16 (surrogate pairs) or UTF-32 wchar_t, invalid codes as U+FFFD
+	void
+	append_utf8(std::string& out, wchar_t const* first, wchar_t const* last)
+	{
+		for (; first != last; ++first) {
+			u32 code = static_cast<u32>(*first) & ((2 == sizeof(wchar_t)) ? 0xFFFFUL : 0xFFFFFFFFUL);
+			if ((0xD800 <= code) && (code <= 0xDBFF) && (first + 1 != last)) {
+				u32 const low = static_cast<u32>(first[1]) & 0xFFFFUL;
+				if ((0xDC00 <= low) && (low <= 0xDFFF)) {
+					code = (((code - 0xD800) << 10) | (low - 0xDC00)) + 0x00010000UL;
+					++first;
+				}
+			}
+			if (((0xD800 <= code) && (code <= 0xDFFF)) || (0x10FFFF < code)) {
+				code = 0xFFFD;
+			}
+			if (code < 0x0080) {
+				out.push_back(static_cast<char>(code));
+			} else if (code < 0x0800) {
+				out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+				out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+			} else if (code < 0x10000) {
+				out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+				out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+			} else {
+				out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+				out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+				out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+			}
+		}
+	}
+
+	enum channel {
+		channel_out,  // std::wcout
+		channel_log,  // std::wclog
+		channel_err   // std::wcerr
+	};
+
+	void emit_line(channel ch, std::wstring const& line, std::wstreambuf* original);
+
+	// collects the characters of a stream up to the newline (the stream
+	// is unbuffered, so every insertion ends in overflow() or xsputn())
+	class line_buffer : public std::wstreambuf {
+		line_buffer(line_buffer const&) GENOME_DELETE_FUNCTION;
+		line_buffer& operator=(line_buffer const&) GENOME_DELETE_FUNCTION;
+	public:
+		explicit line_buffer(channel ch)
+			: std::wstreambuf()
+			, m_channel(ch)
+			, m_stream(0)
+			, m_original(0)
+			, m_line()
+		{
+		}
+		void attach(std::wostream& stream)
+		{
+			m_stream = &stream;
+			m_original = stream.rdbuf(this);
+		}
+		void detach(void)
+		{
+			if (m_stream && (m_stream->rdbuf() == this)) {
+				m_stream->rdbuf(m_original);
+			}
+			m_stream = 0;
+		}
+		std::wstreambuf* original(void) const
+		{
+			return (m_original);
+		}
+	protected:
+		virtual int_type overflow(int_type c) GENOME_OVERRIDE
+		{
+			if (traits_type::eq_int_type(c, traits_type::eof())) {
+				return (traits_type::not_eof(c));
+			}
+			char_type const chr = traits_type::to_char_type(c);
+			return ((1 == xsputn(&chr, 1)) ? c : traits_type::eof());
+		}
+		virtual std::streamsize xsputn(char_type const* s, std::streamsize n) GENOME_OVERRIDE
+		{
+			try {
+				char_type const* const end = s + n;
+				for (;;) {
+					char_type const* const eol = std::find(s, end, L'\n');
+					m_line.append(s, eol);
+					if (eol == end) {
+						break;
+					}
+					emit_line(m_channel, m_line, m_original);
+					m_line.erase();
+					s = eol + 1;
+				}
+			} catch (...) {
+				return (0);
+			}
+			return (n);
+		}
+		virtual int sync(void) GENOME_OVERRIDE
+		{
+			// std::endl ends up here after the newline (the lines are
+			// already queued or written, only the original is flushed)
+			return ((m_original && (m_original->pubsync() < 0)) ? -1 : 0);
+		}
+	private:
+		channel          m_channel;
+		std::wostream*   m_stream;
+		std::wstreambuf* m_original;
+		std::wstring     m_line;
+	};
+
+	class log_state {
+		log_state(log_state const&) GENOME_DELETE_FUNCTION;
+		log_state& operator=(log_state const&) GENOME_DELETE_FUNCTION;
+		enum config {
+			pending_limit = 1024 * 1024  // flush larger output early
+		};
+		log_state(void)
+			: m_queue()
+			, m_level(level_info)
+			, m_buffered(true)
+			, m_pending(0)
+			, m_out(channel_out)
+			, m_log(channel_log)
+			, m_err(channel_err)
+		{
+			m_out.attach(std::wcout);
+			m_log.attach(std::wclog);
+			m_err.attach(std::wcerr);
+		}
+		~log_state(void)
+		{
+			try {
+				flush();
+			} catch (...) {
+				// nothing left to report to
+			}
+			m_err.detach();
+			m_log.detach();
+			m_out.detach();
+		}
+	public:
+		static
+		log_state& instance(void)
+		{
+			//NOTE: called from logger::init() (see filesystem's mount_list)
+			static log_state s_instance;
+			return (s_instance);
+		}
+		void set_level(level max_level)
+		{
+			m_level = max_level;
+		}
+		bool enabled(level lvl) const
+		{
+			return (lvl <= m_level);
+		}
+		void set_buffered(bool buffered)
+		{
+			flush();
+			m_buffered = buffered;
+		}
+		void emit(channel ch, std::wstring const& line, std::wstreambuf* original)
+		{
+			level lvl = level_fail;
+			if (channel_out == ch) {
+				lvl = level_report;
+			} else if (channel_log == ch) {
+				lvl = (0 == line.compare(0, 6, L";fail:")) ? level_fail : (
+					(0 == line.compare(0, 6, L";warn:")) ? level_warn : level_info);
+			}
+			if (!enabled(lvl)) {
+				return;
+			}
+			if (!m_buffered && original) {
+				original->sputn(line.data(), static_cast<std::streamsize>(line.size()));
+				original->sputc(L'\n');
+				original->pubsync();
+				return;
+			}
+			line_entry* const entry = new line_entry(lvl);
+			try {
+				entry->text.reserve(line.size() + 1);
+				append_utf8(entry->text, line.data(), line.data() + line.size());
+				entry->text.push_back('\n');
+			} catch (...) {
+				delete entry;
+				throw;
+			}
+			m_pending += entry->text.size();
+			m_queue.push(entry);
+			if ((level_fail == lvl) || (pending_limit < m_pending)) {
+				flush();
+			}
+		}
+		void flush(void)
+		{
+			line_entry* const lines = m_queue.take();
+			m_pending = 0;
+			std::FILE* last = 0;
+			for (line_entry const* entry = lines; entry; entry = entry->next) {
+				std::FILE* const file = (level_report == entry->lvl) ? stdout : stderr;
+				if (last && (last != file)) {
+					std::fflush(last);
+				}
+				std::fwrite(entry->text.data(), 1, entry->text.size(), file);
+				last = file;
+			}
+			if (last) {
+				std::fflush(last);
+			}
+			line_queue::release(lines);
+		}
+	private:
+		line_queue  m_queue;
+		level       m_level;
+		bool        m_buffered;
+		std::size_t m_pending;  // queued octets (of the standard streams)
+		line_buffer m_out;
+		line_buffer m_log;
+		line_buffer m_err;
+	};
+
+	void
+	emit_line(channel ch, std::wstring const& line, std::wstreambuf* original)
+	{
+		log_state::instance().emit(ch, line, original);
+	}
+
+} // namespace genome::logger::{anonymous}
+
+void
+init(void)
+{
+	log_state::instance();
+}
+
+void
+set_level(level max_level)
+{
+	log_state::instance().set_level(max_level);
+}
+
+bool
+enabled(level lvl)
+{
+	return (log_state::instance().enabled(lvl));
+}
+
+void
+set_buffered(bool buffered)
+{
+	log_state::instance().set_buffered(buffered);
+}
+
+void
+flush(void)
+{
+	log_state::instance().flush();
+}
+
+} // namespace genome::logger
+} // namespace genome
@@ -0,0 +1,69 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_LOGGER_HPP
+#define GENOME_LOGGER_HPP
+
+#include <genome/genome.hpp>
+
+//
+// Buffered console output.
+//
+// logger::init() replaces the stream buffers of std::wcout, std::wclog and
+// std::wcerr. Complete lines are encoded to UTF-8 (without the locale) and
+// queued until the next flush() (the program flushes after every command,
+// and all queued lines are written before a line of level_fail).
+//
+// The level of a std::wclog line is taken from its tag (";fail:", ";warn:",
+// ";info:"), std::wcout lines are reports and std::wcerr lines failures.
+//
+// With set_buffered(false) the lines are passed to the original buffers
+// of the streams (converted with the imbued locale and flushed per line).
+//
+// The streams and the logger functions are NOT thread-safe, they are only
+// used by the main thread (parallel_for tasks collect their output and the
+// main thread prints it after the tasks are finished).
+//
+
+namespace genome {
+namespace logger {
+
+enum level {
+	level_fail,
+	level_warn,
+	level_report,
+	level_info
+};
+
+// called by init_genome()
+void init(void);
+// lines above max_level are dropped (default: level_info)
+void set_level(level max_level);
+bool enabled(level lvl);
+// queue UTF-8 lines (default) or write them directly with the locale
+void set_buffered(bool buffered);
+// write all queued lines (to stdout for level_report, to stderr otherwise)
+void flush(void);
+
+} // namespace genome::logger
+} // namespace genome
+
+#endif // GENOME_LOGGER_HPP
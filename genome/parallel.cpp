@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/parallel.hpp>
+#if !!GENOME_CXX11
+# include <atomic>
+# include <exception>
+# include <mutex>
+# include <system_error>
+# include <thread>
+# include <vector>
+#endif
+
+namespace genome {
+
+//
+// parallel_task
+//
+
+parallel_task::~parallel_task(void)
+{
+}
+
+//
+// parallel_for
+//
+
+#if !!GENOME_CXX11
+
+namespace /*{anonymous}*/ {
+
+	class parallel_worker {
+	public:
+		parallel_worker(parallel_task& task, std::size_t count)
+			: m_task(task)
+			, m_count(count)
+			, m_next(0)
+			, m_mutex()
+			, m_error()
+		{
+		}
+		void operator()(void)
+		{
+			for (;;) {
+				std::size_t const index = m_next.fetch_add(1);
+				if (index >= m_count) {
+					break;
+				}
+				try {
+					m_task.run(index);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(m_mutex);
+					if (!m_error) {
+						m_error = std::current_exception();
+					}
+					m_next.store(m_count);
+				}
+			}
+		}
+		void rethrow(void) const
+		{
+			if (m_error) {
+				std::rethrow_exception(m_error);
+			}
+		}
+	private:
+		parallel_worker(parallel_worker const&) GENOME_DELETE_FUNCTION;
+		parallel_worker& operator=(parallel_worker const&) GENOME_DELETE_FUNCTION;
+		parallel_task&           m_task;
+		std::size_t const        m_count;
+		std::atomic<std::size_t> m_next;
+		std::mutex               m_mutex;
+		std::exception_ptr       m_error;
+	};
+
+} // namespace genome::{anonymous}
+
+std::size_t
+parallel_concurrency(void)
+{
+	unsigned int const n = std::thread::hardware_concurrency();
+	return (n ? static_cast<std::size_t>(n) : std::size_t(1));
+}
+
+void
+parallel_for(parallel_task& task, std::size_t count, std::size_t threads)
+{
+	if (0 == threads) {
+		threads = parallel_concurrency();
+	}
+	if (threads > count) {
+		threads = count;
+	}
+	parallel_worker worker(task, count);
+	if (threads <= 1) {
+		worker();
+	} else {
+		std::vector<std::thread> pool;
+		pool.reserve(threads - 1);
+		for (std::size_t i = 1; i < threads; ++i) {
+			try {
+				pool.push_back(std::thread(std::ref(worker)));
+			} catch (std::system_error const&) {
+				break;  // continue with the already started threads
+			}
+		}
+		worker();
+		for (std::vector<std::thread>::iterator t = pool.begin(); t != pool.end(); ++t) {
+			t->join();
+		}
+	}
+	worker.rethrow();
+}
+
+#else
+
+std::size_t
+parallel_concurrency(void)
+{
+	return (1);
+}
+
+void
+parallel_for(parallel_task& task, std::size_t count, std::size_t /*threads*/)
+{
+	for (std::size_t i = 0; i < count; ++i) {
+		task.run(i);
+	}
+}
+
+#endif
+
+} // namespace genome
@@ -0,0 +1,51 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_PARALLEL_HPP
+#define GENOME_PARALLEL_HPP
+
+#include <genome/genome.hpp>
+
+namespace genome {
+
+//
+// parallel_for (worker threads with C++11, serial otherwise)
+//
+
+class parallel_task {
+public:
+	virtual ~parallel_task(void);
+	// called once for every index in [0, count), concurrently for
+	// different indices (the implementation has to be thread-safe)
+	virtual void run(std::size_t index) = 0;
+};
+
+// number of hardware threads (1 if threads are not supported)
+std::size_t parallel_concurrency(void);
+
+// Runs task.run() for all indices on up to 'threads' threads (0 = all).
+// The first exception thrown by a task is rethrown after all workers
+// finished (remaining indices are skipped).
+void parallel_for(parallel_task& task, std::size_t count, std::size_t threads = 0);
+
+} // namespace genome
+
+#endif // GENOME_PARALLEL_HPP
@@ -0,0 +1,601 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/profile.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <locale>
+#include <map>
+#include <new>
+#include <sstream>
+#include <utility>
+#include <vector>
+#if !!GENOME_CXX11
+# include <atomic>
+# include <mutex>
+#endif
+
+// clock_gettime(clockid_t, struct timespec*)
+#ifndef GENOME_HAVE_CLOCK_GETTIME
+# if defined(__unix__) || defined(__APPLE__)
+#  define GENOME_HAVE_CLOCK_GETTIME 1
+# else
+#  define GENOME_HAVE_CLOCK_GETTIME 0
+# endif
+#endif
+#if !!GENOME_HAVE_CLOCK_GETTIME
+# include <time.h>
+#endif
+
+// QueryPerformanceCounter(LARGE_INTEGER*)
+// GetThreadTimes(HANDLE, FILETIME*, FILETIME*, FILETIME*, FILETIME*)
+#ifndef GENOME_HAVE_GETTHREADTIMES
+# ifdef _WIN32
+#  define GENOME_HAVE_GETTHREADTIMES 1
+# else
+#  define GENOME_HAVE_GETTHREADTIMES 0
+# endif
+#endif
+#if !!GENOME_HAVE_GETTHREADTIMES
+# ifndef WIN32_LEAN_AND_MEAN
+#  define WIN32_LEAN_AND_MEAN
+# endif
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#endif
+
+// malloc_usable_size(void*) / _msize(void*) / malloc_size(void const*)
+#ifndef GENOME_HAVE_MALLOC_USABLE_SIZE
+# if defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
+#  define GENOME_HAVE_MALLOC_USABLE_SIZE 1
+# else
+#  define GENOME_HAVE_MALLOC_USABLE_SIZE 0
+# endif
+#endif
+#if !!GENOME_PROFILE_ALLOCATIONS && !!GENOME_HAVE_MALLOC_USABLE_SIZE
+# ifdef __APPLE__
+#  include <malloc/malloc.h>
+# else
+#  include <malloc.h>
+# endif
+#endif
+
+// getrusage(int, struct rusage*)
+#ifndef GENOME_HAVE_GETRUSAGE
+# if defined(__unix__) || defined(__APPLE__)
+#  define GENOME_HAVE_GETRUSAGE 1
+# else
+#  define GENOME_HAVE_GETRUSAGE 0
+# endif
+#endif
+#if !!GENOME_HAVE_GETRUSAGE
+# include <sys/resource.h>
+#endif
+
+// GetProcessMemoryInfo(HANDLE, PROCESS_MEMORY_COUNTERS*, DWORD)
+#ifndef GENOME_HAVE_GETPROCESSMEMORYINFO
+# if !!GENOME_HAVE_GETTHREADTIMES && defined(_MSC_VER)
+#  define GENOME_HAVE_GETPROCESSMEMORYINFO 1
+# else
+#  define GENOME_HAVE_GETPROCESSMEMORYINFO 0
+# endif
+#endif
+#if !!GENOME_HAVE_GETPROCESSMEMORYINFO
+# include <psapi.h>
+# pragma comment(lib, "psapi.lib")
+#endif
+
+namespace genome {
+namespace profile {
+
+namespace /*{anonymous}*/ {
+
+#if !!GENOME_PROFILE_ALLOCATIONS
+# if !!GENOME_CXX11
+	thread_local
+# endif
+	u64 s_allocations = 0;  // operator new calls of this thread
+# if !!GENOME_CXX11
+	thread_local
+# endif
+	u64 s_allocated = 0;  // operator new octets of this thread
+# if !!GENOME_CXX11
+	thread_local
+# endif
+	u64 s_scope_peak = 0;  // live heap peak since the innermost scope of this thread started
+	// process-wide heap counters (NOT thread-safe without C++11)
+# if !!GENOME_CXX11
+	std::atomic<u64> s_heap_allocs(0);
+	std::atomic<u64> s_heap_live(0);
+	std::atomic<u64> s_heap_peak(0);
+# else
+	u64 s_heap_allocs = 0;
+	u64 s_heap_live = 0;
+	u64 s_heap_peak = 0;
+# endif
+
+	// usable size of a malloc() block (0 if unknown)
+	std::size_t
+	heap_block_size(void* p)
+	{
+# if !!GENOME_HAVE_MALLOC_USABLE_SIZE
+#  if defined(_WIN32)
+		return (_msize(p));
+#  elif defined(__APPLE__)
+		return (malloc_size(p));
+#  else
+		return (malloc_usable_size(p));
+#  endif
+# else
+		return ((void)p, 0);
+# endif
+	}
+
+	void
+	heap_allocated(void* p)
+	{
+		std::size_t const size = heap_block_size(p);
+		++s_allocations;
+		s_allocated += size;
+# if !!GENOME_CXX11
+		s_heap_allocs.fetch_add(1, std::memory_order_relaxed);
+		u64 const live = s_heap_live.fetch_add(size, std::memory_order_relaxed) + size;
+		u64 peak = s_heap_peak.load(std::memory_order_relaxed);
+		while ((peak < live) && !s_heap_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+# else
+		++s_heap_allocs;
+		s_heap_live += size;
+		if (s_heap_peak < s_heap_live) {
+			s_heap_peak = s_heap_live;
+		}
+		u64 const live = s_heap_live;
+# endif
+		if (s_scope_peak < live) {
+			s_scope_peak = live;
+		}
+	}
+
+	void
+	heap_released(void* p)
+	{
+		std::size_t const size = p ? heap_block_size(p) : 0;
+# if !!GENOME_CXX11
+		s_heap_live.fetch_sub(size, std::memory_order_relaxed);
+# else
+		s_heap_live -= size;
+# endif
+	}
+#endif
+
+	// monotonic wall clock in microseconds
+	u64
+	wall_time(void)
+	{
+#if !!GENOME_HAVE_CLOCK_GETTIME
+		struct timespec ts;
+		if (0 == clock_gettime(CLOCK_MONOTONIC, &ts)) {
+			return (u64(ts.tv_sec) * 1000000U + u64(ts.tv_nsec) / 1000U);
+		}
+#elif !!GENOME_HAVE_GETTHREADTIMES
+		LARGE_INTEGER freq;
+		LARGE_INTEGER count;
+		if (QueryPerformanceFrequency(&freq) && QueryPerformanceCounter(&count) && (freq.QuadPart > 0)) {
+			return (u64(count.QuadPart / freq.QuadPart) * 1000000U + u64(count.QuadPart % freq.QuadPart) * 1000000U / u64(freq.QuadPart));
+		}
+#endif
+		return (u64(std::clock()) * 1000000U / u64(CLOCKS_PER_SEC));
+	}
+
+	// CPU time of the calling thread in microseconds
+	// (of the process if the platform does not support it)
+	u64
+	cpu_time(void)
+	{
+#if !!GENOME_HAVE_CLOCK_GETTIME && defined(CLOCK_THREAD_CPUTIME_ID)
+		struct timespec ts;
+		if (0 == clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) {
+			return (u64(ts.tv_sec) * 1000000U + u64(ts.tv_nsec) / 1000U);
+		}
+#elif !!GENOME_HAVE_GETTHREADTIMES
+		FILETIME creation;
+		FILETIME exit;
+		FILETIME kernel;
+		FILETIME user;
+		if (GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+			return ((
+				((u64(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime) +
+				((u64(user.dwHighDateTime) << 32) | user.dwLowDateTime)) / 10U);
+		}
+#endif
+		return (u64(std::clock()) * 1000000U / u64(CLOCKS_PER_SEC));
+	}
+
+	u64
+	allocations(void)
+	{
+#if !!GENOME_PROFILE_ALLOCATIONS
+		return (s_allocations);
+#else
+		return (0);
+#endif
+	}
+
+	u64
+	allocated_bytes(void)
+	{
+#if !!GENOME_PROFILE_ALLOCATIONS
+		return (s_allocated);
+#else
+		return (0);
+#endif
+	}
+
+	// peak resident set size of the process in octets (0 if unknown)
+	u64
+	peak_rss(void)
+	{
+#if !!GENOME_HAVE_GETRUSAGE
+		struct rusage usage;
+		if (0 == getrusage(RUSAGE_SELF, &usage)) {
+# ifdef __APPLE__
+			return (u64(usage.ru_maxrss));
+# else
+			return (u64(usage.ru_maxrss) * 1024U);
+# endif
+		}
+#elif !!GENOME_HAVE_GETPROCESSMEMORYINFO
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return (u64(counters.PeakWorkingSetSize));
+		}
+#endif
+		return (0);
+	}
+
+	struct phase {
+		phase(std::string const& phase_name, std::string const& phase_detail)
+			: name(phase_name)
+			, detail(phase_detail)
+			, calls(0)
+			, wall(0)
+			, cpu(0)
+			, allocs(0)
+			, alloc_bytes(0)
+			, live_bytes(0)
+			, peak_bytes(0)
+			, peak_rss(0)
+			, items(0)
+			, bytes_in(0)
+			, bytes_out(0)
+		{
+		}
+		std::string name;
+		std::string detail;
+		u64 calls;
+		u64 wall;
+		u64 cpu;
+		u64 allocs;
+		u64 alloc_bytes;
+		u64 live_bytes;  // at the end of the last call
+		u64 peak_bytes;  // heap high-water mark above the start of any call
+		u64 peak_rss;
+		u64 items;
+		u64 bytes_in;
+		u64 bytes_out;
+	};
+
+	void
+	append_json_string(std::string& out, std::string const& str)
+	{
+		static char const hex[] = "0123456789abcdef";
+		out.push_back('"');
+		for (std::string::const_iterator c = str.begin(); c != str.end(); ++c) {
+			unsigned char const u = static_cast<unsigned char>(*c);
+			if (('"' == *c) || ('\\' == *c)) {
+				out.push_back('\\');
+				out.push_back(*c);
+			} else if ((u < 0x20) || (u >= 0x7F)) {
+				// the names are not necessarily UTF-8 (Windows-1252 as Latin-1)
+				out.append("\\u00");
+				out.push_back(hex[u >> 4]);
+				out.push_back(hex[u & 0xF]);
+			} else {
+				out.push_back(*c);
+			}
+		}
+		out.push_back('"');
+	}
+
+	class phase_list {
+		typedef std::map<std::pair<std::string, std::string>, std::size_t> phase_index;
+		std::vector<phase> m_phases;
+		phase_index m_index;
+#if !!GENOME_CXX11
+		std::mutex m_mutex;
+#endif
+		phase_list(void)
+			: m_phases()
+			, m_index()
+#if !!GENOME_CXX11
+			, m_mutex()
+#endif
+		{
+		}
+		~phase_list(void)
+		{
+		}
+	public:
+		static
+		phase_list& instance(void)
+		{
+			//NOTE: called from profile::init() (see filesystem's mount_list)
+			static phase_list s_instance;
+			return (s_instance);
+		}
+		void add(phase const& data)
+		{
+#if !!GENOME_CXX11
+			std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+			std::pair<phase_index::iterator, bool> const ins = m_index.insert(
+				std::make_pair(std::make_pair(data.name, data.detail), m_phases.size()));
+			if (ins.second) {
+				m_phases.push_back(phase(data.name, data.detail));
+			}
+			phase& p = m_phases[ins.first->second];
+			p.calls += data.calls;
+			p.wall += data.wall;
+			p.cpu += data.cpu;
+			p.allocs += data.allocs;
+			p.alloc_bytes += data.alloc_bytes;
+			p.live_bytes = data.live_bytes;
+			p.peak_bytes = std::max(p.peak_bytes, data.peak_bytes);
+			p.peak_rss = std::max(p.peak_rss, data.peak_rss);
+			p.items += data.items;
+			p.bytes_in += data.bytes_in;
+			p.bytes_out += data.bytes_out;
+		}
+		std::size_t size(void)
+		{
+#if !!GENOME_CXX11
+			std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+			return (m_phases.size());
+		}
+		void clear(void)
+		{
+#if !!GENOME_CXX11
+			std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+			m_phases.clear();
+			m_index.clear();
+		}
+		std::string json(void)
+		{
+#if !!GENOME_CXX11
+			std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+			std::ostringstream num;
+			num.imbue(std::locale::classic());
+			std::string out("{\n\t\"version\": 1,\n\t\"allocations\": ");
+			out.append(GENOME_PROFILE_ALLOCATIONS ? "true" : "false");
+			out.append(",\n\t\"heap_bytes\": ");
+			out.append((GENOME_PROFILE_ALLOCATIONS && GENOME_HAVE_MALLOC_USABLE_SIZE) ? "true" : "false");
+			out.append(",\n\t\"phases\": [");
+			for (std::vector<phase>::const_iterator p = m_phases.begin(); p != m_phases.end(); ++p) {
+				num.str(std::string());
+				num <<
+					", \"calls\": " << p->calls <<
+					", \"wall_us\": " << p->wall <<
+					", \"cpu_us\": " << p->cpu <<
+					", \"items\": " << p->items <<
+					", \"bytes_in\": " << p->bytes_in <<
+					", \"bytes_out\": " << p->bytes_out <<
+					", \"allocs\": " << p->allocs <<
+					", \"alloc_bytes\": " << p->alloc_bytes <<
+					", \"live_bytes\": " << p->live_bytes <<
+					", \"peak_bytes\": " << p->peak_bytes <<
+					", \"peak_rss\": " << p->peak_rss << "}";
+				out.append((p != m_phases.begin()) ? ",\n\t\t{\"name\": " : "\n\t\t{\"name\": ");
+				append_json_string(out, p->name);
+				out.append(", \"detail\": ");
+				append_json_string(out, p->detail);
+				out.append(num.str());
+			}
+			out.append(m_phases.empty() ? "]\n}\n" : "\n\t]\n}\n");
+			return (out);
+		}
+	};
+
+} // namespace genome::profile::{anonymous}
+
+//
+// scope
+//
+
+scope::scope(char const* name, std::string const& detail)
+	: m_name(name)
+	, m_detail(detail)
+	, m_wall(wall_time())
+	, m_cpu(cpu_time())
+	, m_allocs(allocations())
+	, m_alloc_bytes(allocated_bytes())
+	, m_live_bytes(0)
+	, m_outer_peak(0)
+	, m_items(0)
+	, m_bytes_in(0)
+	, m_bytes_out(0)
+{
+#if !!GENOME_PROFILE_ALLOCATIONS
+	// the peak of this scope starts at the current live heap
+	m_live_bytes = s_heap_live;
+	m_outer_peak = s_scope_peak;
+	s_scope_peak = m_live_bytes;
+#endif
+}
+
+scope::~scope(void)
+{
+	try {
+		phase data(m_name, m_detail);
+		data.calls = 1;
+		data.wall = wall_time() - m_wall;
+		data.cpu = cpu_time() - m_cpu;
+		data.allocs = allocations() - m_allocs;
+		data.alloc_bytes = allocated_bytes() - m_alloc_bytes;
+		memory_usage const heap = memory();
+		data.live_bytes = heap.live_bytes;
+#if !!GENOME_PROFILE_ALLOCATIONS
+		data.peak_bytes = std::max(s_scope_peak, heap.live_bytes) - m_live_bytes;
+#endif
+		data.peak_rss = heap.peak_rss;
+		data.items = m_items;
+		data.bytes_in = m_bytes_in;
+		data.bytes_out = m_bytes_out;
+		phase_list::instance().add(data);
+	} catch (...) {
+		// the profile is not worth an exception while unwinding
+	}
+#if !!GENOME_PROFILE_ALLOCATIONS
+	// the enclosing scope includes the peak of this one
+	s_scope_peak = std::max(s_scope_peak, m_outer_peak);
+#endif
+}
+
+void
+scope::add_items(u64 count) GENOME_NOEXCEPT_NOTHROW
+{
+	m_items += count;
+}
+
+void
+scope::add_bytes_in(u64 count) GENOME_NOEXCEPT_NOTHROW
+{
+	m_bytes_in += count;
+}
+
+void
+scope::add_bytes_out(u64 count) GENOME_NOEXCEPT_NOTHROW
+{
+	m_bytes_out += count;
+}
+
+//
+// profile
+//
+
+void
+init(void)
+{
+	phase_list::instance();
+}
+
+std::size_t
+size(void)
+{
+	return (phase_list::instance().size());
+}
+
+void
+clear(void)
+{
+	phase_list::instance().clear();
+}
+
+std::string
+report_json(void)
+{
+	return (phase_list::instance().json());
+}
+
+memory_usage
+memory(void)
+{
+	memory_usage heap;
+#if !!GENOME_PROFILE_ALLOCATIONS
+	heap.allocs = s_heap_allocs;
+	heap.live_bytes = s_heap_live;
+	heap.peak_bytes = s_heap_peak;
+#else
+	heap.allocs = 0;
+	heap.live_bytes = 0;
+	heap.peak_bytes = 0;
+#endif
+	heap.peak_rss = peak_rss();
+	return (heap);
+}
+
+} // namespace genome::profile
+} // namespace genome
+
+#if !!GENOME_PROFILE_ALLOCATIONS
+
+//
+// global operator new/delete (counting the allocations per thread,
+// and the heap octets of the process)
+//
+
+void*
+operator new(std::size_t size)
+#if !GENOME_CXX11
+	throw (std::bad_alloc)
+#endif
+{
+	if (0 == size) {
+		size = 1;
+	}
+	for (;;) {
+		void* const p = std::malloc(size);
+		if (p) {
+			genome::profile::heap_allocated(p);
+			return (p);
+		}
+		std::new_handler const handler = std::set_new_handler(0);
+		std::set_new_handler(handler);
+		if (!handler) {
+			throw std::bad_alloc();
+		}
+		handler();
+	}
+}
+
+// GCC 11+ warns about the free() if this is inlined into std::allocator code
+#if defined(__GNUC__) && (__GNUC__ >= 11)
+# pragma GCC diagnostic push
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void
+operator delete(void* p) GENOME_NOEXCEPT_NOTHROW
+{
+	genome::profile::heap_released(p);
+	std::free(p);
+}
+
+#if defined(__GNUC__) && (__GNUC__ >= 11)
+# pragma GCC diagnostic pop
+#endif
+
+#endif//GENOME_PROFILE_ALLOCATIONS
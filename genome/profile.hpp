@@ -0,0 +1,96 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#ifndef GENOME_PROFILE_HPP
+#define GENOME_PROFILE_HPP
+
+#include <genome/genome.hpp>
+#include <string>
+
+//
+// Per-phase timers and counters.
+//
+// A profile::scope adds its wall time, the CPU time and the allocations
+// of its thread, and its counters to the phase with the same name and
+// detail (e.g. a file or column name). The times of nested scopes are
+// included in the outer ones. Scopes can be used on worker threads.
+//
+// The allocations are only counted with GENOME_PROFILE_ALLOCATIONS (off by
+// default, needs C++11, replaces the global operator new/delete). The heap
+// octets are only known if the platform reports the size of a block; at
+// the end of each scope the phase also records the live heap, the peak
+// resident set size of the process, and the heap high-water mark of the
+// scope (above the live heap at its start, seen by the allocations of its
+// thread and of its nested scopes).
+//
+
+#ifndef GENOME_PROFILE_ALLOCATIONS
+# define GENOME_PROFILE_ALLOCATIONS 0
+#endif
+
+namespace genome {
+namespace profile {
+
+class scope {
+public:
+	explicit scope(char const* name, std::string const& detail = std::string());
+	~scope(void);
+	void add_items(u64 count) GENOME_NOEXCEPT_NOTHROW;
+	void add_bytes_in(u64 count) GENOME_NOEXCEPT_NOTHROW;
+	void add_bytes_out(u64 count) GENOME_NOEXCEPT_NOTHROW;
+private:
+	scope(scope const&) GENOME_DELETE_FUNCTION;
+	scope& operator=(scope const&) GENOME_DELETE_FUNCTION;
+	char const* m_name;
+	std::string m_detail;
+	u64 m_wall;
+	u64 m_cpu;
+	u64 m_allocs;
+	u64 m_alloc_bytes;
+	u64 m_live_bytes;  // live heap at the start
+	u64 m_outer_peak;  // heap peak of the enclosing scope (restored at the end)
+	u64 m_items;
+	u64 m_bytes_in;
+	u64 m_bytes_out;
+};
+
+// called by init_genome()
+void init(void);
+// number of recorded phases
+std::size_t size(void);
+// remove all recorded phases
+void clear(void);
+// JSON report of all phases (in the order of their first start)
+std::string report_json(void);
+
+struct memory_usage {
+	u64 allocs;      // operator new calls (all threads)
+	u64 live_bytes;  // heap octets currently allocated with operator new
+	u64 peak_bytes;  // high-water mark of live_bytes
+	u64 peak_rss;    // peak resident set size of the process (0 = unknown)
+};
+// current heap counters (zero without GENOME_PROFILE_ALLOCATIONS)
+memory_usage memory(void);
+
+} // namespace genome::profile
+} // namespace genome
+
+#endif // GENOME_PROFILE_HPP
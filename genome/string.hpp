@@ -62,6 +62,7 @@ namespace byte_code {
 	GENOME_CONSTEXPR_CONST byte_char upper_first     = 0x41;  // 'A'
 	GENOME_CONSTEXPR_CONST byte_char upper_last      = 0x5A;  // 'Z'
 	GENOME_CONSTEXPR_CONST byte_char reverse_solidus = 0x5C;  // '\\'
+	GENOME_CONSTEXPR_CONST byte_char low_line        = 0x5F;  // '_'
 	GENOME_CONSTEXPR_CONST byte_char lower_first     = 0x61;  // 'a'
 	GENOME_CONSTEXPR_CONST byte_char hex_first       = 0x61;  // 'a'
 	GENOME_CONSTEXPR_CONST byte_char hex_last        = 0x66;  // 'f'
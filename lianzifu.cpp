@@ -1,6 +1,9 @@
 #include <genome/genome.hpp>
 #include <genome/filesystem.hpp>
+#include <genome/hash_recovery.hpp>
 #include <genome/locale.hpp>
+#include <genome/logger.hpp>
+#include <genome/profile.hpp>
 #include <genome/localization/stringtable.hpp>
 #include <cstdlib>
 #include <iostream>
@@ -22,6 +25,20 @@ genome::platform const default_plt = genome::platform_x64;
 int const default_ver = 6;
 int const default_cmp = 9;
 int const default_utf = 1;
+char const* const default_csc = "";
+char const* const default_sta = "#G3:/lianzifu.state";
+char const* const default_rec = "#G3:/lianzifu-recovered.csv";
+int const default_len = 4;
+char const* const default_wrd = "";
+int const default_chg = 1;
+char const* const default_pkc = "#G3:/lianzifu-cache";
+int const default_mib = 256;
+int const default_vfy = 1;
+int const default_kpk = 1;
+char const* const default_prf = "#G3:/lianzifu-profile.json";
+int const default_lvl = 3;
+int const default_buf = 1;
+int const default_mem = 1;
 
 void
 init_locale(void)
@@ -77,23 +94,48 @@ print_help(int exit_code)
 	out << L"  --exit                                   exit the program now" << std::endl;
 	out << L"  --clear                                  reset string table state" << std::endl;
 	out << L"  --read-ini [ini]                         add prefix/csv from <ini>" << std::endl;
-	out << L"  --read-csv [utf]                         add strings from all csv" << std::endl;
+	out << L"  --read-csv [utf] [csc]                   add strings from all csv" << std::endl;
 	out << L"  --save-map [map]                         save [prefix:]id to <map>" << std::endl;
 	out << L"  --save-bin [plt] [ver] [bin] [cmp] [flt] save string table to <bin>" << std::endl;
 	out << L"  --read-map [map]                         add [prefix:]id from <map>" << std::endl;
 	out << L"  --read-bin [bin]                         add csv/strings from <bin>" << std::endl;
 	out << L"  --save-csv                               save strings to all csv" << std::endl;
+	out << L"  --save-state [sta]                       save string table to <sta>" << std::endl;
+	out << L"  --load-state [sta]                       load string table from <sta>" << std::endl;
+	out << L"  --recover-ids [rec] [len] [wrd]          recover unknown ids to <rec>" << std::endl;
+	out << L"  --skip-unchanged [chg]                   write only changed files" << std::endl;
+	out << L"  --pack-cache [pkc] [mib]                 reuse packed columns from <pkc>" << std::endl;
+	out << L"  --verify [vfy]                           decode and compare saved bins" << std::endl;
+	out << L"  --keep-packed [kpk]                      keep packed columns for --save-bin" << std::endl;
+	out << L"  --bin-info [bin]...                      print tables/statistics of <bin>s" << std::endl;
+	out << L"  --profile [prf]                          save phase timings/counters to <prf>" << std::endl;
+	out << L"  --log [lvl] [buf]                        set log level and buffering" << std::endl;
+	out << L"  --memory [mem]                           print memory usage after commands" << std::endl;
 	out << std::endl;
 	out << L"Defaults:" << std::endl;
 	out << std::endl;
 	out << L"  <ini>  " << genome::to_wstring(std::string(default_ini)) << std::endl;
 	out << L"  <utf>  " << genome::to_wstring(default_utf) << std::endl;
+	out << L"  <csc>  " << (*default_csc ? genome::to_wstring(std::string(default_csc)) : std::wstring(L"(none)")) << std::endl;
 	out << L"  <map>  " << genome::to_wstring(std::string(default_map)) << std::endl;
 	out << L"  <plt>  " << genome::to_wstring(std::string(genome::platform_name(default_plt))) << std::endl;
 	out << L"  <ver>  " << genome::to_wstring(default_ver) << std::endl;
 	out << L"  <bin>  " << genome::to_wstring(std::string(default_bin)) << std::endl;
 	out << L"  <cmp>  " << genome::to_wstring(default_cmp) << std::endl;
 	out << L"  <flt>  " << genome::to_wstring(std::string(default_flt)) << std::endl;
+	out << L"  <sta>  " << genome::to_wstring(std::string(default_sta)) << std::endl;
+	out << L"  <rec>  " << genome::to_wstring(std::string(default_rec)) << std::endl;
+	out << L"  <len>  " << genome::to_wstring(default_len) << std::endl;
+	out << L"  <wrd>  " << (*default_wrd ? genome::to_wstring(std::string(default_wrd)) : std::wstring(L"(none)")) << std::endl;
+	out << L"  <chg>  " << genome::to_wstring(default_chg) << std::endl;
+	out << L"  <pkc>  " << genome::to_wstring(std::string(default_pkc)) << std::endl;
+	out << L"  <mib>  " << genome::to_wstring(default_mib) << std::endl;
+	out << L"  <vfy>  " << genome::to_wstring(default_vfy) << std::endl;
+	out << L"  <kpk>  " << genome::to_wstring(default_kpk) << std::endl;
+	out << L"  <prf>  " << genome::to_wstring(std::string(default_prf)) << std::endl;
+	out << L"  <lvl>  " << genome::to_wstring(default_lvl) << std::endl;
+	out << L"  <buf>  " << genome::to_wstring(default_buf) << std::endl;
+	out << L"  <mem>  " << genome::to_wstring(default_mem) << std::endl;
 	out << std::endl;
 	out << L"Platforms:" << std::endl;
 	out << std::endl;
@@ -142,6 +184,110 @@ print_help(int exit_code)
 	out << L"  The latter two are extensions to the Genome CSV format to" << std::endl;
 	out << L"  permit encoding of field separators and escape sequences." << std::endl;
 	out << std::endl;
+	out << L"CSV cache:" << std::endl;
+	out << std::endl;
+	out << L"  If a <csc> file is specified, the parsed CSV records are" << std::endl;
+	out << L"  stored in (and reused from) this file. A CSV is only read" << std::endl;
+	out << L"  again if its modification time or size has been changed." << std::endl;
+	out << std::endl;
+	out << L"State file:" << std::endl;
+	out << std::endl;
+	out << L"  --save-state stores the complete string table state (all" << std::endl;
+	out << L"  sources, id names, id hashes, and column strings) in a" << std::endl;
+	out << L"  binary snapshot. --load-state replaces the current state" << std::endl;
+	out << L"  with the snapshot, so the INI/CSV/map parsing is skipped." << std::endl;
+	out << std::endl;
+	out << L"Multiple targets:" << std::endl;
+	out << std::endl;
+	out << L"  --save-bin <plt:[ver]:[bin]>... [cmp] [flt] packs all the" << std::endl;
+	out << L"  columns only once and saves them to all of the targets," << std::endl;
+	out << L"  an empty <ver> or <bin> selects the platform's default." << std::endl;
+	out << L"  (e.g. --save-bin x64:6: ps3:5: x360:: 9 \"*\")" << std::endl;
+	out << std::endl;
+	out << L"Unchanged files:" << std::endl;
+	out << std::endl;
+	out << L"  With --skip-unchanged 1 the following --save-csv/map/bin" << std::endl;
+	out << L"  and --recover-ids commands render the files in memory (or" << std::endl;
+	out << L"  in a temporary file for bins) and only replace the files" << std::endl;
+	out << L"  with different content (keeping the file times of the" << std::endl;
+	out << L"  others). The bins and the recovered ids are always written" << std::endl;
+	out << L"  through a temporary file, a failed command keeps the old" << std::endl;
+	out << L"  file. --skip-unchanged 0 restores the default." << std::endl;
+	out << std::endl;
+	out << L"Pack cache:" << std::endl;
+	out << std::endl;
+	out << L"  With --pack-cache the following --save-bin commands keep" << std::endl;
+	out << L"  each packed column in <pkc>, keyed by a hash of the id" << std::endl;
+	out << L"  order, the strings, and the compression. Columns without" << std::endl;
+	out << L"  changes are loaded instead of compressed again, and the" << std::endl;
+	out << L"  least recently used entries are removed if the cache gets" << std::endl;
+	out << L"  larger than <mib> MiB. A <mib> of 0 disables the cache." << std::endl;
+	out << std::endl;
+	out << L"Verification:" << std::endl;
+	out << std::endl;
+	out << L"  With --verify 1 the following --save-bin commands decode" << std::endl;
+	out << L"  every packed column in memory (like --read-bin) and check" << std::endl;
+	out << L"  each row against the column strings before the files are" << std::endl;
+	out << L"  completed. The first mismatch fails the command and keeps" << std::endl;
+	out << L"  the old files. --verify 0 disables it." << std::endl;
+	out << std::endl;
+	out << L"Packed columns:" << std::endl;
+	out << std::endl;
+	out << L"  --save-bin only keeps the column it is currently packing" << std::endl;
+	out << L"  in memory. With --keep-packed 1 the packed columns are" << std::endl;
+	out << L"  kept for the following --save-bin commands, so variants" << std::endl;
+	out << L"  with other filters or targets reuse them (while no ids" << std::endl;
+	out << L"  or strings are changed). --keep-packed 0 releases them." << std::endl;
+	out << std::endl;
+	out << L"BIN inspection:" << std::endl;
+	out << std::endl;
+	out << L"  --bin-info reads only the header, source, column name and" << std::endl;
+	out << L"  column tables of all given files (on the worker threads)" << std::endl;
+	out << L"  and prints the same keys as --read-bin, one [bin] section" << std::endl;
+	out << L"  per file. The string table state is not changed, and the" << std::endl;
+	out << L"  command fails after printing if any file is not valid." << std::endl;
+	out << std::endl;
+	out << L"Profile:" << std::endl;
+	out << std::endl;
+	out << L"  The wall/CPU time, allocations, items and bytes of every" << std::endl;
+	out << L"  phase (read_csv per file, pack_col per column/strategy," << std::endl;
+	out << L"  suffix_tree, save_bin, save_csv per file, ...) are summed" << std::endl;
+	out << L"  up from the program start. --profile saves them as JSON." << std::endl;
+	out << std::endl;
+	out << L"Memory usage:" << std::endl;
+	out << std::endl;
+	out << L"  With --memory 1 a [memory] section follows the report of" << std::endl;
+	out << L"  every command: the allocations, live and peak heap bytes," << std::endl;
+	out << L"  the peak resident set size, and the allocated capacity of" << std::endl;
+	out << L"  the id tables, each column, the packed tables, and of the" << std::endl;
+	out << L"  suffix trees. The profile phases record the live heap at" << std::endl;
+	out << L"  their end, and their own heap peak (above the live heap" << std::endl;
+	out << L"  at their start). The heap is only counted in builds with" << std::endl;
+	out << L"  LIANZIFU_PROFILE_ALLOCATIONS (the counts are 0 otherwise)," << std::endl;
+	out << L"  heap bytes are 0 if the platform does not report them." << std::endl;
+	out << std::endl;
+	out << L"Log output:" << std::endl;
+	out << std::endl;
+	out << L"  <lvl> 0 prints only failures, 1 adds warnings, 2 adds the" << std::endl;
+	out << L"  command reports, and 3 adds the informational messages." << std::endl;
+	out << L"  With <buf> 1 the lines are written as UTF-8 after every" << std::endl;
+	out << L"  command (and before failures). --log 3 0 restores the" << std::endl;
+	out << L"  unbuffered output that is converted with the locale." << std::endl;
+	out << std::endl;
+	out << L"ID recovery:" << std::endl;
+	out << std::endl;
+	out << L"  --recover-ids tests candidates for all id hashes without" << std::endl;
+	out << L"  a name. Known ids are split at '_' into heads (\"ACH_\")," << std::endl;
+	out << L"  tails (\"_DESC\"), and words, which are combined with the" << std::endl;
+	out << L"  words from <wrd> (one per line, UTF-8) and [a-z0-9_] up to" << std::endl;
+	out << L"  <len> characters (0 = none, at most " << genome::to_wstring(int(genome::hash_recovery::max_brute_force_length)) << L") on all CPU threads." << std::endl;
+	out << L"  The brute force only uses the " << genome::to_wstring(int(genome::hash_recovery::brute_force_heads)) << L" most frequent heads" << std::endl;
+	out << L"  and the " << genome::to_wstring(int(genome::hash_recovery::brute_force_tails)) << L" most frequent tails." << std::endl;
+	out << L"  The matches are saved to <rec> (map format) and used for" << std::endl;
+	out << L"  the following commands. Brute force matches and hashes" << std::endl;
+	out << L"  with more than one candidate name are likely to be false" << std::endl;
+	out << L"  positives of the 32-bit hash (warned); review <rec>." << std::endl;
+	out << std::endl;
 	out << L"Examples:" << std::endl;
 	out << std::endl;
 	out << L"  create " << genome::to_wstring(std::string(default_bin)) << L" (" << genome::to_wstring(std::string(genome::platform_name(default_plt))) << L" v" << genome::to_wstring(default_ver) << L") from CSVs" << std::endl;
@@ -158,6 +304,65 @@ print_help(int exit_code)
 	out << std::endl;
 }
 
+genome::localization::stringtable::compression
+parse_compression(std::string const& arg)
+{
+	int level = atoi(arg.c_str());
+	if ((level < 0) || (9 < level) || (genome::to_string(level) != arg)) {
+		throw std::invalid_argument("invalid compression level");
+	}
+	return (
+		(level <= 0) ? genome::localization::stringtable::compression_none : (
+		(level <= 1) ? genome::localization::stringtable::compression_fast : (
+		(level <= 4) ? genome::localization::stringtable::compression_lzpb : (
+		(level <= 6) ? genome::localization::stringtable::compression_lzex : (
+		(level <= 8) ? genome::localization::stringtable::compression_tree :
+		               genome::localization::stringtable::compression_best)))));
+}
+
+void
+save_profile(std::string const& path)
+{
+	std::wcout << L"[" << genome::to_wstring(path) << L"]" << std::endl;
+	std::string const json(genome::profile::report_json());
+	bool written = false;
+	if (!genome::filesystem::ensure_directories(path.c_str()) ||
+		!genome::filesystem::update_file(path.c_str(), json.data(), json.size(), written)) {
+		throw std::runtime_error("failed to write profile");
+	}
+	std::wcout << L"phases=" << genome::to_wstring(genome::profile::size()) << std::endl;
+	std::wcout << std::endl;
+}
+
+// "plt:" prefix with a known platform name (the version and path are optional)
+bool
+is_bin_target(std::string const& arg)
+{
+	std::string::size_type const n = arg.find(':');
+	return ((n != std::string::npos) && (genome::platform_unknown != genome::platform_from_name(arg.substr(0, n).c_str())));
+}
+
+genome::localization::stringtable::bin_target
+parse_bin_target(std::string const& arg)
+{
+	std::string::size_type const n = arg.find(':');
+	std::string::size_type m = arg.find(':', n + 1);
+	if (std::string::npos == m) {
+		m = arg.size();
+	}
+	genome::platform const target = genome::platform_from_name(arg.substr(0, n).c_str());
+	std::string const ver(arg.substr(n + 1, m - n - 1));
+	int version = 0;  // platform default
+	if (!ver.empty()) {
+		version = atoi(ver.c_str());
+		if ((version < 5) || (255 < version) || (genome::to_string(version) != ver)) {
+			throw std::invalid_argument("invalid string table version");
+		}
+	}
+	std::string const bin((m < arg.size()) ? arg.substr(m + 1) : std::string());
+	return (genome::localization::stringtable::make_bin_target(target, genome::u8(version), bin.c_str()));
+}
+
 bool
 cmd_next(int& argc, char**& argv, std::string& cmd, std::vector<std::string>& args)
 {
@@ -202,6 +407,7 @@ main(int argc, char* argv[])
 			std::string cmd;
 			std::vector<std::string> args;
 			genome::localization::stringtable stb;
+			bool print_memory = false;
 			do {
 				if (!cmd_next(argc, argv, cmd, args)) {
 					throw std::invalid_argument("invalid command '" + cmd + "'");
@@ -241,17 +447,20 @@ main(int argc, char* argv[])
 
 				} else if ("read-csv" == cmd) {
 
-					if (args.size() > 1) {
+					if (args.size() > 2) {
 						throw std::invalid_argument("too many arguments for --" + cmd);
 					}
 					if (args.size() < 1) {
 						args.push_back(genome::to_string(default_utf));
 					}
+					if (args.size() < 2) {
+						args.push_back(default_csc);
+					}
 					int utf = atoi(args[0].c_str());
 					if ((utf < 0) || (1 < utf) || (genome::to_string(utf) !=  args[0])) {
 						throw std::invalid_argument("invalid UTF flag");
 					}
-					stb.read_csv(!!utf);
+					stb.read_csv(!!utf, args[1].c_str());
 
 				} else if ("save-map" == cmd) {
 
@@ -263,6 +472,30 @@ main(int argc, char* argv[])
 					}
 					stb.save_map(args[0].c_str());
 
+				} else if (("save-bin" == cmd) && !args.empty() && is_bin_target(args[0])) {
+
+					// --save-bin <plt:[ver]:[bin]>... [cmp] [flt]
+					genome::localization::stringtable::bin_target_list targets;
+					std::size_t n = 0;
+					for (; (n < args.size()) && is_bin_target(args[n]); ++n) {
+						targets.push_back(parse_bin_target(args[n]));
+					}
+					args.erase(args.begin(), args.begin() + static_cast<std::ptrdiff_t>(n));
+					if (args.size() > 2) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_cmp));
+					}
+					if (args.size() < 2) {
+						args.push_back(default_flt);
+					}
+					genome::byte_string filter;
+					if (!genome::string_convert(args[1], filter)) {
+						throw std::invalid_argument("invalid column filter");
+					}
+					stb.save_bin(targets, parse_compression(args[0]), filter);
+
 				} else if ("save-bin" == cmd) {
 
 					if (args.size() > 5) {
@@ -291,17 +524,7 @@ main(int argc, char* argv[])
 					if ((version < 5) || (255 < version) || (genome::to_string(version) !=  args[1])) {
 						throw std::invalid_argument("invalid string table version");
 					}
-					int level = atoi(args[3].c_str());
-					if ((level < 0) || (9 < level) || (genome::to_string(level) != args[3])) {
-						throw std::invalid_argument("invalid compression level");
-					}
-					genome::localization::stringtable::compression comp =
-						(level <= 0) ? genome::localization::stringtable::compression_none : (
-						(level <= 1) ? genome::localization::stringtable::compression_fast : (
-						(level <= 4) ? genome::localization::stringtable::compression_lzpb : (
-						(level <= 6) ? genome::localization::stringtable::compression_lzex : (
-						(level <= 8) ? genome::localization::stringtable::compression_tree :
-						               genome::localization::stringtable::compression_best))));
+					genome::localization::stringtable::compression comp = parse_compression(args[3]);
 					genome::byte_string filter;
 					if (!genome::string_convert(args[4], filter)) {
 						throw std::invalid_argument("invalid column filter");
@@ -335,15 +558,172 @@ main(int argc, char* argv[])
 					}
 					stb.save_csv();
 
+				} else if ("save-state" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(default_sta);
+					}
+					stb.save_state(args[0].c_str());
+
+				} else if ("load-state" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(default_sta);
+					}
+					stb.load_state(args[0].c_str());
+
+				} else if ("skip-unchanged" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_chg));
+					}
+					int chg = atoi(args[0].c_str());
+					if ((chg < 0) || (1 < chg) || (genome::to_string(chg) != args[0])) {
+						throw std::invalid_argument("invalid skip-unchanged flag");
+					}
+					stb.set_skip_unchanged(!!chg);
+
+				} else if ("pack-cache" == cmd) {
+
+					if (args.size() > 2) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(default_pkc);
+					}
+					if (args.size() < 2) {
+						args.push_back(genome::to_string(default_mib));
+					}
+					int mib = atoi(args[1].c_str());
+					if ((mib < 0) || (1048576 < mib) || (genome::to_string(mib) != args[1])) {
+						throw std::invalid_argument("invalid pack cache size");
+					}
+					stb.set_pack_cache(args[0].c_str(), genome::u64(mib) << 20);
+
+				} else if ("verify" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_vfy));
+					}
+					int vfy = atoi(args[0].c_str());
+					if ((vfy < 0) || (1 < vfy) || (genome::to_string(vfy) != args[0])) {
+						throw std::invalid_argument("invalid verify flag");
+					}
+					stb.set_verify_bin(!!vfy);
+
+				} else if ("keep-packed" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_kpk));
+					}
+					int kpk = atoi(args[0].c_str());
+					if ((kpk < 0) || (1 < kpk) || (genome::to_string(kpk) != args[0])) {
+						throw std::invalid_argument("invalid keep-packed flag");
+					}
+					stb.set_keep_packed(!!kpk);
+
+				} else if ("profile" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(default_prf);
+					}
+					save_profile(args[0]);
+
+				} else if ("log" == cmd) {
+
+					if (args.size() > 2) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_lvl));
+					}
+					if (args.size() < 2) {
+						args.push_back(genome::to_string(default_buf));
+					}
+					int lvl = atoi(args[0].c_str());
+					if ((lvl < genome::logger::level_fail) || (genome::logger::level_info < lvl) || (genome::to_string(lvl) != args[0])) {
+						throw std::invalid_argument("invalid log level");
+					}
+					int buf = atoi(args[1].c_str());
+					if ((buf < 0) || (1 < buf) || (genome::to_string(buf) != args[1])) {
+						throw std::invalid_argument("invalid log buffering flag");
+					}
+					genome::logger::set_level(genome::logger::level(lvl));
+					genome::logger::set_buffered(!!buf);
+
+				} else if ("memory" == cmd) {
+
+					if (args.size() > 1) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(genome::to_string(default_mem));
+					}
+					int mem = atoi(args[0].c_str());
+					if ((mem < 0) || (1 < mem) || (genome::to_string(mem) != args[0])) {
+						throw std::invalid_argument("invalid memory flag");
+					}
+					print_memory = !!mem;
+
+				} else if ("bin-info" == cmd) {
+
+					if (args.size() < 1) {
+						args.push_back(default_bin);
+					}
+					genome::localization::stringtable::print_bin_info(args);
+
+				} else if ("recover-ids" == cmd) {
+
+					if (args.size() > 3) {
+						throw std::invalid_argument("too many arguments for --" + cmd);
+					}
+					if (args.size() < 1) {
+						args.push_back(default_rec);
+					}
+					if (args.size() < 2) {
+						args.push_back(genome::to_string(default_len));
+					}
+					if (args.size() < 3) {
+						args.push_back(default_wrd);
+					}
+					int length = atoi(args[1].c_str());
+					if ((length < 0) || (genome::hash_recovery::max_brute_force_length < length) || (genome::to_string(length) != args[1])) {
+						throw std::invalid_argument("invalid brute force length");
+					}
+					stb.recover_ids(args[0].c_str(), std::size_t(length), args[2].c_str());
+
 				} else {
 
 					throw std::invalid_argument("unsupported command '" + cmd + "'");
 
 				}
+				if (print_memory) {
+					stb.print_memory();
+				}
+				genome::logger::flush();
 			} while (argc > 0);
 		}
 
 	} catch (std::exception& e) {
+		genome::logger::flush();
 		std::cerr << ";fail: (" << genome::get_exception_name(e) << ") " << e.what() << std::endl;
 		exit_code = EXIT_FAILURE;
 	}
@@ -0,0 +1,100 @@
+//
+// Copyright (c) 2018 Nico Bendlin <nico@nicode.net>
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <genome/genome.hpp>
+#include <genome/archive.hpp>
+#include <genome/string.hpp>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+//
+// lianzifu_bench (optional, see LIANZIFU_BENCH in CMakeLists.txt)
+//
+// Times the byte order conversion paths of the archives and checks
+// that all of them produce the same output as the scalar path.
+//
+
+namespace /*{anonymous}*/ {
+
+// 1M values plus a tail that is not a complete 16-octet block
+std::size_t const bench_count = (1 << 20) + 7;
+int const bench_rounds = 100;
+
+char const* const swap_path_name[] = { "scalar", "sse2", "ssse3" };
+
+template<typename T>
+bool
+bench_swap_octets(char const* type)
+{
+	std::vector<T> src(bench_count);
+	genome::u32 seed = 0x12345678UL;
+	for (std::size_t i = 0; i < src.size(); ++i) {
+		seed = seed * 1664525UL + 1013904223UL;
+		src[i] = static_cast<T>(seed ^ (seed >> 13));
+	}
+	std::vector<T> expected(src.size());
+	genome::detail::swap_octets(&src[0], &expected[0], src.size(), genome::detail::swap_path_scalar);
+	bool same = true;
+	for (int p = genome::detail::swap_path_scalar; p <= genome::detail::swap_path_ssse3; ++p) {
+		genome::detail::swap_path const path = genome::detail::swap_path(p);
+		std::wcout << L"[" << genome::to_wstring(std::string(type)) << L"." << genome::to_wstring(std::string(swap_path_name[p])) << L"]" << std::endl;
+		if (!genome::detail::swap_path_supported(path)) {
+			std::wcout << L"supported=0" << std::endl;
+			std::wcout << std::endl;
+			continue;
+		}
+		std::vector<T> dst(src.size());
+		std::clock_t const start = std::clock();
+		for (int round = 0; round < bench_rounds; ++round) {
+			genome::detail::swap_octets(&src[0], &dst[0], src.size(), path);
+		}
+		double const seconds = double(std::clock() - start) / double(CLOCKS_PER_SEC);
+		bool const equal = (dst == expected);
+		same = same && equal;
+		std::wcout << L"supported=1" << std::endl;
+		std::wcout << L"count=" << genome::to_wstring(src.size()) << std::endl;
+		std::wcout << L"rounds=" << genome::to_wstring(bench_rounds) << std::endl;
+		std::wcout << L"seconds=" << std::fixed << seconds << std::endl;
+		if (seconds > 0) {
+			std::wcout << L"mib_per_second=" << std::fixed << (double(src.size() * sizeof(T)) * bench_rounds / seconds / 1048576.0) << std::endl;
+		}
+		std::wcout << L"equal=" << genome::to_wstring(equal ? 1 : 0) << std::endl;
+		std::wcout << std::endl;
+	}
+	return (same);
+}
+
+} // namespace {anonymous}
+
+int
+main(void)
+{
+	bool same = bench_swap_octets<genome::u16>("swap_octets.u16");
+	same = bench_swap_octets<genome::u32>("swap_octets.u32") && same;
+	if (!same) {
+		std::wclog << L";fail: the conversion paths produce different output" << std::endl;
+		return (EXIT_FAILURE);
+	}
+	return (EXIT_SUCCESS);
+}